@@ -0,0 +1,487 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <numbers>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "reactorcore.h"
+
+// Every benchmark builds its molecules from the same seed and density, and restores
+// the initial state before each measured step, so runs on different commits compare.
+static const uint32_t BENCH_SEED = 20251017;
+static const double BENCH_MOLECULE_DENSITY = 0.01; // molecules per core coordinate unit^2
+static const double BENCH_STEP_SECS = REACTOR_CORE_UPDATE_SECS;
+static const size_t BENCH_COLLISION_DELTA_MOLECULES_CNT = 1024;
+static const double BENCH_WALL_GAP = 0.01;
+static const size_t BENCH_WARMUP_STEPS_CNT = 100;
+static const double BENCH_PISTON_STROKE_SHARE = 0.5;
+// every BENCH_GROWN_QUADRIT_PERIOD-th molecule of the mixed sizes core is a grown Quadrit
+static const size_t BENCH_GROWN_QUADRIT_PERIOD = 64;
+static const int BENCH_GROWN_QUADRIT_MASS = 20;
+
+// global operator new replacement: counts heap allocations so steady-state stepping
+// can be checked to stay allocation free
+static std::atomic<size_t> heapAllocationsCnt(0);
+
+static void *countedAlloc(const size_t size, const size_t alignment) {
+    heapAllocationsCnt.fetch_add(1, std::memory_order_relaxed);
+
+    size_t alignedSize = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    void *ptr = (alignment > alignof(std::max_align_t)) ? std::aligned_alloc(alignment, alignedSize) : std::malloc(alignedSize);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new(size_t size) { return countedAlloc(size, alignof(std::max_align_t)); }
+void *operator new[](size_t size) { return countedAlloc(size, alignof(std::max_align_t)); }
+void *operator new(size_t size, std::align_val_t alignment) { return countedAlloc(size, size_t(alignment)); }
+void *operator new[](size_t size, std::align_val_t alignment) { return countedAlloc(size, size_t(alignment)); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+class ReactorCoreBench {
+public:
+    // everything a step changes, so every measured step can start from the same core
+    struct CoreState {
+        MoleculeStore moleculeStore;
+        CoreObservables observables;
+        double pistonPosition;
+        double pistonSpeed;
+        double currentTime;
+    };
+
+    static MoleculeStore &getMoleculeStore(ReactorCore &reactorCore) { return reactorCore.moleculeStore; }
+
+    static CoreState saveCoreState(const ReactorCore &reactorCore) {
+        return CoreState{reactorCore.moleculeStore, reactorCore.observables, reactorCore.pistonPosition,
+                         reactorCore.pistonSpeed, reactorCore.currentReactorCoreTime};
+    }
+
+    // copy assignments keep the capacity of the core's buffers, restoring allocates nothing
+    static void restoreCoreState(ReactorCore &reactorCore, const CoreState &coreState) {
+        reactorCore.moleculeStore = coreState.moleculeStore;
+        reactorCore.observables = coreState.observables;
+        reactorCore.setPistonWall(coreState.pistonPosition);
+        reactorCore.pistonSpeed = coreState.pistonSpeed;
+        reactorCore.currentReactorCoreTime = coreState.currentTime;
+    }
+
+    static double getMoleculeCollisionDelta(ReactorCore &reactorCore, const size_t fstMoleculeIndex, const size_t sndMoleculeIndex) {
+        return reactorCore.getMoleculeCollisionDelta(fstMoleculeIndex, sndMoleculeIndex);
+    }
+
+    static bool isMoleculesInContact(ReactorCore &reactorCore, const size_t fstMoleculeIndex, const size_t sndMoleculeIndex) {
+        return reactorCore.isMoleculesInContact(fstMoleculeIndex, sndMoleculeIndex);
+    }
+};
+
+static gm_vector<double, 2> genBenchSpeedVector(std::mt19937 &randomGenerator) {
+    std::uniform_real_distribution<double> angleDistribution(0, 2 * std::numbers::pi);
+    std::uniform_real_distribution<double> speedDistribution(MoleculeMinInitSpeed, MoleculeMaxInitSpeed);
+
+    double angle = angleDistribution(randomGenerator);
+    double speed = speedDistribution(randomGenerator);
+    return gm_vector<double, 2>(std::cos(angle) * speed, std::sin(angle) * speed);
+}
+
+// square core with BENCH_MOLECULE_DENSITY, two Circlits per Quadrit
+static std::unique_ptr<ReactorCore> makeBenchReactorCore(const size_t moleculesCnt) {
+    double coreSide = std::sqrt(moleculesCnt / BENCH_MOLECULE_DENSITY);
+    auto reactorCore = std::make_unique<ReactorCore>(coreSide, coreSide);
+
+    std::mt19937 randomGenerator(BENCH_SEED);
+    std::uniform_real_distribution<double> cordDistribution(0, coreSide);
+
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        gm_vector<double, 2> position(cordDistribution(randomGenerator), cordDistribution(randomGenerator));
+        reactorCore->addMolecule(i % 3 ? CIRCLIT : QUADRIT, position, genBenchSpeedVector(randomGenerator));
+    }
+
+    return reactorCore;
+}
+
+// the same core with a few heavy Quadrits, as CirclitQuadritReaction grows them over a long run
+static std::unique_ptr<ReactorCore> makeMixedSizesBenchReactorCore(const size_t moleculesCnt) {
+    double coreSide = std::sqrt(moleculesCnt / BENCH_MOLECULE_DENSITY);
+    auto reactorCore = std::make_unique<ReactorCore>(coreSide, coreSide);
+
+    std::mt19937 randomGenerator(BENCH_SEED);
+    std::uniform_real_distribution<double> cordDistribution(0, coreSide);
+
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        gm_vector<double, 2> position(cordDistribution(randomGenerator), cordDistribution(randomGenerator));
+
+        if (i % BENCH_GROWN_QUADRIT_PERIOD == 0)
+            reactorCore->addMolecule(QUADRIT, position, genBenchSpeedVector(randomGenerator), BENCH_GROWN_QUADRIT_MASS);
+        else
+            reactorCore->addMolecule(i % 3 ? CIRCLIT : QUADRIT, position, genBenchSpeedVector(randomGenerator));
+    }
+
+    return reactorCore;
+}
+
+static void benchReactorCoreStep(benchmark::State &state, ReactorCore &reactorCore) {
+    const ReactorCoreBench::CoreState initialCoreState = ReactorCoreBench::saveCoreState(reactorCore);
+
+    // structures kept between steps (sort order, tree) are built from scratch by the first step only
+    reactorCore.step(BENCH_STEP_SECS);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        ReactorCoreBench::restoreCoreState(reactorCore, initialCoreState);
+        state.ResumeTiming();
+
+        reactorCore.step(BENCH_STEP_SECS);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * initialCoreState.moleculeStore.size());
+}
+
+static void BM_ReactorCoreStep(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->setCollisionDetectionMode(UNIFORM_GRID_DETECTION);
+
+    benchReactorCoreStep(state, *reactorCore);
+}
+BENCHMARK(BM_ReactorCoreStep)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReactorCoreStepBruteForce(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->setCollisionDetectionMode(BRUTE_FORCE_DETECTION);
+
+    benchReactorCoreStep(state, *reactorCore);
+}
+BENCHMARK(BM_ReactorCoreStepBruteForce)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReactorCoreStepSweepAndPrune(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->setCollisionDetectionMode(SWEEP_AND_PRUNE_DETECTION);
+
+    benchReactorCoreStep(state, *reactorCore);
+}
+BENCHMARK(BM_ReactorCoreStepSweepAndPrune)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReactorCoreStepAabbTree(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->setCollisionDetectionMode(AABB_TREE_DETECTION);
+
+    benchReactorCoreStep(state, *reactorCore);
+}
+BENCHMARK(BM_ReactorCoreStepAabbTree)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// Arg(1) is the detection mode, so the grid and the size aware modes compare on the same molecules
+static void BM_ReactorCoreStepMixedSizes(benchmark::State &state) {
+    auto reactorCore = makeMixedSizesBenchReactorCore(state.range(0));
+    reactorCore->setCollisionDetectionMode(CollisionDetectionMode(state.range(1)));
+
+    benchReactorCoreStep(state, *reactorCore);
+}
+BENCHMARK(BM_ReactorCoreStepMixedSizes)
+    ->Args({10000, UNIFORM_GRID_DETECTION})->Args({10000, SWEEP_AND_PRUNE_DETECTION})
+    ->Args({10000, AABB_TREE_DETECTION})
+    ->Args({100000, UNIFORM_GRID_DETECTION})->Args({100000, SWEEP_AND_PRUNE_DETECTION})
+    ->Args({100000, AABB_TREE_DETECTION})
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_ReactorCoreStepEventDriven(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->setSteppingMode(EVENT_DRIVEN_MODE);
+
+    benchReactorCoreStep(state, *reactorCore);
+}
+BENCHMARK(BM_ReactorCoreStepEventDriven)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReactorCoreStepAdaptive(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->setSteppingMode(ADAPTIVE_STEP_MODE);
+
+    benchReactorCoreStep(state, *reactorCore);
+    state.counters["substeps"] = reactorCore->getAdaptiveStepStats().substepsCnt;
+}
+BENCHMARK(BM_ReactorCoreStepAdaptive)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReactorCoreStepParallel(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->setThreadsCnt(std::max(1u, std::thread::hardware_concurrency()));
+
+    benchReactorCoreStep(state, *reactorCore);
+}
+BENCHMARK(BM_ReactorCoreStepParallel)->Arg(100000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// continuous compression cycles: the piston travels back and forth over half of the core
+static void BM_ReactorCoreStepPistonCycle(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->reserveMolecules(2 * state.range(0));
+
+    double pistonStroke = reactorCore->getCordSysWidth() * BENCH_PISTON_STROKE_SHARE;
+    reactorCore->setPistonTarget(pistonStroke);
+
+    for (auto _ : state) {
+        if (reactorCore->getPistonPosition() == reactorCore->getPistonTarget())
+            reactorCore->setPistonTarget(reactorCore->getPistonTarget() > 0 ? 0 : pistonStroke);
+
+        reactorCore->step(BENCH_STEP_SECS);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReactorCoreStepPistonCycle)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// continuous stepping after warm-up: reactions keep killing and spawning molecules,
+// heap_allocs_per_step is expected to stay zero
+static void BM_ReactorCoreStepHeapAllocations(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->reserveMolecules(2 * state.range(0));
+
+    for (size_t i = 0; i < BENCH_WARMUP_STEPS_CNT; i++)
+        reactorCore->step(BENCH_STEP_SECS);
+
+    size_t stepHeapAllocationsCnt = 0;
+    for (auto _ : state) {
+        size_t prevHeapAllocationsCnt = heapAllocationsCnt.load(std::memory_order_relaxed);
+        reactorCore->step(BENCH_STEP_SECS);
+        stepHeapAllocationsCnt += heapAllocationsCnt.load(std::memory_order_relaxed) - prevHeapAllocationsCnt;
+    }
+
+    state.counters["heap_allocs_per_step"] = benchmark::Counter(stepHeapAllocationsCnt, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ReactorCoreStepHeapAllocations)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+// per-step cost of filling and publishing the render snapshot, the consumer takes every frame
+static void BM_PublishRenderSnapshot(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    RenderSnapshotBuffer renderSnapshots;
+
+    size_t publishHeapAllocationsCnt = 0;
+    for (auto _ : state) {
+        size_t prevHeapAllocationsCnt = heapAllocationsCnt.load(std::memory_order_relaxed);
+        reactorCore->fillRenderSnapshot(renderSnapshots.getBackSlot());
+        renderSnapshots.publish();
+        publishHeapAllocationsCnt += heapAllocationsCnt.load(std::memory_order_relaxed) - prevHeapAllocationsCnt;
+
+        benchmark::DoNotOptimize(renderSnapshots.acquireFrontSlot().xs.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["heap_allocs_per_publish"] = benchmark::Counter(publishHeapAllocationsCnt, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_PublishRenderSnapshot)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// warm start: the checkpoint is loaded again and again into the same core, whose storage is
+// already allocated, so this measures the mapped read and the bulk copies only
+static void BM_LoadCoreSnapshot(benchmark::State &state) {
+    std::string snapshotPath = (std::filesystem::temp_directory_path() / "reactor_bench_core.snap").string();
+
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    if (!reactorCore->saveSnapshot(snapshotPath)) {
+        state.SkipWithError("can't write the snapshot file");
+        return;
+    }
+
+    for (auto _ : state) {
+        bool isLoaded = reactorCore->loadSnapshot(snapshotPath);
+        benchmark::DoNotOptimize(isLoaded);
+    }
+
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(snapshotPath));
+    std::filesystem::remove(snapshotPath);
+}
+BENCHMARK(BM_LoadCoreSnapshot)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// step cost with every tick recorded, compare with BM_ReactorCoreStep
+static void BM_ReactorCoreStepRecorded(benchmark::State &state) {
+    std::string trajectoryPath = (std::filesystem::temp_directory_path() / "reactor_bench.traj").string();
+
+    auto reactorCore = makeBenchReactorCore(state.range(0));
+    reactorCore->setCollisionDetectionMode(UNIFORM_GRID_DETECTION);
+
+    auto trajectoryRecorder = std::make_unique<TrajectoryRecorder>(trajectoryPath, /*recordEveryTicks=*/1);
+    if (trajectoryRecorder->isFailed()) {
+        state.SkipWithError("can't write the trajectory file");
+        return;
+    }
+    reactorCore->setTrajectoryRecorder(trajectoryRecorder.get());
+
+    benchReactorCoreStep(state, *reactorCore);
+
+    reactorCore->setTrajectoryRecorder(nullptr);
+    state.counters["dropped"] = double(trajectoryRecorder->getDroppedFramesCnt());
+    trajectoryRecorder.reset();
+    std::filesystem::remove(trajectoryPath);
+}
+BENCHMARK(BM_ReactorCoreStepRecorded)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// every molecule starts next to a wall and flies into it, so each one bounces during the step
+static void BM_IntegrateBoxMovementWallHit(benchmark::State &state) {
+    SimdIsa isa = SimdIsa(state.range(0));
+    if (!isSimdIsaSupported(isa)) {
+        state.SkipWithError("SimdIsa is not supported by this CPU");
+        return;
+    }
+
+    size_t moleculesCnt = state.range(1);
+    double coreSide = std::sqrt(moleculesCnt / BENCH_MOLECULE_DENSITY);
+    ReactorCore reactorCore(coreSide, coreSide);
+
+    std::mt19937 randomGenerator(BENCH_SEED);
+    std::uniform_real_distribution<double> cordDistribution(0, coreSide);
+
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        double alongWall = cordDistribution(randomGenerator);
+        double speed = std::sqrt(genBenchSpeedVector(randomGenerator).get_len2());
+
+        switch (i % 4) {
+            case 0: reactorCore.addMolecule(CIRCLIT, {alongWall, BENCH_WALL_GAP},            {0.5, -speed}); break;
+            case 1: reactorCore.addMolecule(CIRCLIT, {BENCH_WALL_GAP, alongWall},            {-speed, 0.5}); break;
+            case 2: reactorCore.addMolecule(CIRCLIT, {alongWall, coreSide - BENCH_WALL_GAP}, {0.5, speed});  break;
+            case 3: reactorCore.addMolecule(CIRCLIT, {coreSide - BENCH_WALL_GAP, alongWall}, {speed, 0.5});  break;
+        }
+    }
+
+    MoleculeStore &moleculeStore = ReactorCoreBench::getMoleculeStore(reactorCore);
+    const MoleculeStore initialMoleculeStore = moleculeStore;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        moleculeStore = initialMoleculeStore;
+        state.ResumeTiming();
+
+        integrateBoxMovement(moleculeStore.getXs(), moleculeStore.getYs(), moleculeStore.getSpeedXs(), moleculeStore.getSpeedYs(),
+                             moleculesCnt, /*leftWallX=*/0, /*rightWallX=*/coreSide, /*height=*/coreSide, /*leftWallSpeed=*/0,
+                             BENCH_STEP_SECS, isa);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * moleculesCnt);
+}
+BENCHMARK(BM_IntegrateBoxMovementWallHit)
+    ->Args({SCALAR_SIMD_ISA, 10000})->Args({AVX2_SIMD_ISA, 10000})->Args({AVX512_SIMD_ISA, 10000})
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_GetMoleculeCollisionDelta(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(BENCH_COLLISION_DELTA_MOLECULES_CNT);
+
+    for (auto _ : state) {
+        for (size_t fst = 0; fst < BENCH_COLLISION_DELTA_MOLECULES_CNT; fst++) {
+            for (size_t snd = fst + 1; snd < BENCH_COLLISION_DELTA_MOLECULES_CNT; snd++)
+                benchmark::DoNotOptimize(ReactorCoreBench::getMoleculeCollisionDelta(*reactorCore, fst, snd));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_COLLISION_DELTA_MOLECULES_CNT * (BENCH_COLLISION_DELTA_MOLECULES_CNT - 1) / 2);
+}
+BENCHMARK(BM_GetMoleculeCollisionDelta)->Unit(benchmark::kMicrosecond);
+
+// same pairs, almost all of them far apart: measures the bounding circle rejection path
+static void BM_IsMoleculesInContact(benchmark::State &state) {
+    auto reactorCore = makeBenchReactorCore(BENCH_COLLISION_DELTA_MOLECULES_CNT);
+
+    for (auto _ : state) {
+        for (size_t fst = 0; fst < BENCH_COLLISION_DELTA_MOLECULES_CNT; fst++) {
+            for (size_t snd = fst + 1; snd < BENCH_COLLISION_DELTA_MOLECULES_CNT; snd++)
+                benchmark::DoNotOptimize(ReactorCoreBench::isMoleculesInContact(*reactorCore, fst, snd));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_COLLISION_DELTA_MOLECULES_CNT * (BENCH_COLLISION_DELTA_MOLECULES_CNT - 1) / 2);
+}
+BENCHMARK(BM_IsMoleculesInContact)->Unit(benchmark::kMicrosecond);
+
+// same pairs as BM_GetMoleculeCollisionDelta, candidates go in IMPACT_BATCH_MAX_SIZE blocks
+static void BM_ComputeImpactDeltas(benchmark::State &state) {
+    SimdIsa isa = SimdIsa(state.range(0));
+    if (!isSimdIsaSupported(isa)) {
+        state.SkipWithError("SimdIsa is not supported by this CPU");
+        return;
+    }
+
+    auto reactorCore = makeBenchReactorCore(BENCH_COLLISION_DELTA_MOLECULES_CNT);
+    const MoleculeStore &moleculeStore = ReactorCoreBench::getMoleculeStore(*reactorCore);
+    const double *xs = moleculeStore.getXs();
+    const double *ys = moleculeStore.getYs();
+    const double *speedXs = moleculeStore.getSpeedXs();
+    const double *speedYs = moleculeStore.getSpeedYs();
+    const double *collideRadiuses = moleculeStore.getCollideRadiuses();
+
+    double impactDeltas[IMPACT_BATCH_MAX_SIZE];
+
+    for (auto _ : state) {
+        for (size_t fst = 0; fst < BENCH_COLLISION_DELTA_MOLECULES_CNT; fst++) {
+            for (size_t snd = fst + 1; snd < BENCH_COLLISION_DELTA_MOLECULES_CNT; snd += IMPACT_BATCH_MAX_SIZE) {
+                size_t candidatesCnt = std::min(IMPACT_BATCH_MAX_SIZE, BENCH_COLLISION_DELTA_MOLECULES_CNT - snd);
+                uint64_t hitsMask = computeImpactDeltas(
+                    xs[fst], ys[fst], speedXs[fst], speedYs[fst], collideRadiuses[fst],
+                    xs + snd, ys + snd, speedXs + snd, speedYs + snd, collideRadiuses + snd,
+                    candidatesCnt, BENCH_STEP_SECS, impactDeltas, isa
+                );
+                benchmark::DoNotOptimize(hitsMask);
+                benchmark::DoNotOptimize(impactDeltas);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_COLLISION_DELTA_MOLECULES_CNT * (BENCH_COLLISION_DELTA_MOLECULES_CNT - 1) / 2);
+}
+BENCHMARK(BM_ComputeImpactDeltas)
+    ->Arg(SCALAR_SIMD_ISA)->Arg(AVX2_SIMD_ISA)->Arg(AVX512_SIMD_ISA)
+    ->Unit(benchmark::kMicrosecond);
+
+// every deadPeriod-th molecule died this tick and every other one is UNRESPONSIVE, 0 kills none
+static void BM_RemoveDeadMolecules(benchmark::State &state) {
+    size_t moleculesCnt = state.range(0);
+    size_t deadPeriod = state.range(1);
+    std::unique_ptr<ReactorCore> reactorCore = makeBenchReactorCore(moleculesCnt);
+
+    MoleculeStore &moleculeStore = ReactorCoreBench::getMoleculeStore(*reactorCore);
+    for (size_t moleculeIndex = 0; moleculeIndex < moleculesCnt; moleculeIndex++) {
+        bool isDead = deadPeriod > 0 && moleculeIndex % deadPeriod == 0;
+        moleculeStore.setPhysicalState(moleculeIndex, isDead ? DEATH : (moleculeIndex % 2) ? UNRESPONSIVE : ALIVE);
+    }
+    const MoleculeStore initialMoleculeStore = moleculeStore;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        moleculeStore = initialMoleculeStore;
+        state.ResumeTiming();
+
+        moleculeStore.removeDeadMolecules();
+        benchmark::DoNotOptimize(moleculeStore.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * moleculesCnt);
+}
+BENCHMARK(BM_RemoveDeadMolecules)->Args({100000, 0})->Args({100000, 100})->Unit(benchmark::kMicrosecond);
+
+// two Quadrits of the given mass explode into 2 * mass Circlits
+static void BM_QuadritQuadritReactionBurst(benchmark::State &state) {
+    int quadritMass = state.range(0);
+    MoleculeStore moleculeStore;
+
+    for (auto _ : state) {
+        moleculeStore.clear();
+        moleculeStore.addMolecule(QUADRIT, {0, 0}, {1, 0}, quadritMass);
+        moleculeStore.addMolecule(QUADRIT, {1, 0}, {-1, 0}, quadritMass);
+
+        QuadritQuadritReaction(moleculeStore, 0, 1);
+        benchmark::DoNotOptimize(moleculeStore.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * 2 * quadritMass);
+}
+BENCHMARK(BM_QuadritQuadritReactionBurst)->Arg(8)->Arg(64)->Arg(512);
+
+BENCHMARK_MAIN();
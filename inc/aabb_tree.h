@@ -0,0 +1,130 @@
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+static const size_t NONE_AABB_TREE_NODE = std::numeric_limits<size_t>::max();
+
+// Leaf boxes are fattened: stretched along the item displacement over this many update intervals
+// and grown by the extension on every side. Items that stay inside their fat box need no tree work.
+static const double AABB_TREE_DISPLACEMENT_MULTIPLIER = 2;
+static const double AABB_TREE_FAT_EXTENSION = 0.5;
+
+// Dynamic bounding volume tree over the items' bounding squares. It works like the one of Box2D:
+// leaves hold fat boxes, an item is reinserted only when it leaves its fat box, insertion picks
+// the sibling by the perimeter cost heuristic, and every change on the way back to the root refits
+// the ancestor boxes and rotates the nodes whose subtrees differ in height by more than one.
+// Radiuses may differ by orders of magnitude without the search slowing down for the small items.
+class DynamicAabbTree {
+    struct Node {
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+
+        size_t parent;
+        size_t fstChild; // NONE_AABB_TREE_NODE for leaves
+        size_t sndChild;
+        size_t height;   // 0 for leaves
+
+        size_t item;     // leaves only
+        uint32_t key;
+
+        bool isLeaf() const { return fstChild == NONE_AABB_TREE_NODE; }
+    };
+
+    std::vector<Node> nodes;
+    std::vector<size_t> freeNodes;
+    size_t root;
+
+    std::vector<size_t> keyLeaves;
+    std::vector<bool> isKeyPresent;
+
+    // scratch of forEachCandidatePair, kept to reuse capacity
+    std::vector<std::pair<size_t, size_t>> traversalStack;
+
+public:
+    DynamicAabbTree(): root(NONE_AABB_TREE_NODE) {}
+
+    void reserve(const size_t itemsCnt);
+
+    // Item i is centered at (xs[i], ys[i]) with half side radiuses[i] + margin and moves at
+    // (speedXs[i], speedYs[i]) for about deltaSecs until the next update. keys[i] identifies the
+    // item across updates while its index may change; keys are expected to be small and dense.
+    // Items with a new key get a leaf, leaves whose key is gone are removed, the rest are only
+    // reinserted when they left their fat box: the tree is never rebuilt from scratch.
+    void update
+    (
+        const double *xs, const double *ys, const double *speedXs, const double *speedYs,
+        const double *radiuses, const uint32_t *keys, const size_t itemsCnt,
+        const double margin, const double deltaSecs
+    );
+
+    // Calls pairHandle(i, j) once for every unordered pair of items whose fat boxes overlap, touching
+    // borders included. All leaf queries are batched into one traversal of the tree against itself,
+    // which skips a whole pair of subtrees as soon as their boxes are apart.
+    template <typename PairHandle>
+    void forEachCandidatePair(PairHandle &&pairHandle) {
+        traversalStack.clear();
+        if (root != NONE_AABB_TREE_NODE) traversalStack.emplace_back(root, root);
+
+        while (!traversalStack.empty()) {
+            auto [fst, snd] = traversalStack.back();
+            traversalStack.pop_back();
+
+            const Node &fstNode = nodes[fst];
+            const Node &sndNode = nodes[snd];
+
+            if (fst == snd) {
+                if (fstNode.isLeaf()) continue;
+
+                traversalStack.emplace_back(fstNode.fstChild, fstNode.fstChild);
+                traversalStack.emplace_back(fstNode.sndChild, fstNode.sndChild);
+                traversalStack.emplace_back(fstNode.fstChild, fstNode.sndChild);
+                continue;
+            }
+
+            if (!isOverlapping(fstNode, sndNode)) continue;
+
+            if (fstNode.isLeaf() && sndNode.isLeaf()) {
+                pairHandle(fstNode.item, sndNode.item);
+                continue;
+            }
+
+            // descend into the bigger box, so the two sides shrink at a similar pace
+            if (sndNode.isLeaf() || (!fstNode.isLeaf() && getPerimeter(fstNode) >= getPerimeter(sndNode))) {
+                traversalStack.emplace_back(fstNode.fstChild, snd);
+                traversalStack.emplace_back(fstNode.sndChild, snd);
+            } else {
+                traversalStack.emplace_back(fst, sndNode.fstChild);
+                traversalStack.emplace_back(fst, sndNode.sndChild);
+            }
+        }
+    }
+
+    size_t getHeight() const { return (root != NONE_AABB_TREE_NODE) ? nodes[root].height : 0; }
+
+private:
+    static bool isOverlapping(const Node &fst, const Node &snd) {
+        return fst.minX <= snd.maxX && snd.minX <= fst.maxX && fst.minY <= snd.maxY && snd.minY <= fst.maxY;
+    }
+
+    static double getPerimeter(const Node &node) { return 2 * ((node.maxX - node.minX) + (node.maxY - node.minY)); }
+    static double getUnionPerimeter(const Node &fst, const Node &snd);
+    void setUnionBox(const size_t node, const size_t fst, const size_t snd);
+
+    size_t allocateNode();
+    void freeNode(const size_t node);
+
+    void insertLeaf(const size_t leaf);
+    void removeLeaf(const size_t leaf);
+    void refitAncestors(size_t node);
+    size_t balance(const size_t node);
+    void replaceChild(const size_t parent, const size_t oldChild, const size_t newChild);
+};
+
+#endif // AABB_TREE_H
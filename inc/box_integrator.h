@@ -0,0 +1,43 @@
+#ifndef BOX_INTEGRATOR_H
+#define BOX_INTEGRATOR_H
+
+#include "simd_isa.h"
+
+#include <cstddef>
+
+// Moves molecules [0, moleculesCnt) for deltaSecs inside the box [leftWallX, rightWallX] x [0, height],
+// reflecting them off the walls as points. Each axis is folded independently: the free flight
+// position is mapped back into the box and the speed flips once per wall hit, so any number of
+// bounces per step is handled without branches. Molecules found outside the box are folded in.
+// The left wall may be a piston moving at leftWallSpeed: it is taken at its end of step position,
+// and every hit on it reflects the speed in the piston frame, v' = 2 leftWallSpeed - v, molecules
+// it swept over included. All kernels give bit-identical results.
+void integrateBoxMovement
+(
+    double *xs, double *ys, double *speedXs, double *speedYs, const size_t moleculesCnt,
+    const double leftWallX, const double rightWallX, const double height, const double leftWallSpeed,
+    const double deltaSecs, const SimdIsa isa=getBestSimdIsa()
+);
+
+// Momentum the molecules handed to each wall of the box during integrateBoxMovement, taken along
+// the wall normal pointing out of the box, so it is positive for every wall.
+struct BoxWallImpulses {
+    double leftWall = 0;
+    double rightWall = 0;
+    double lowWall = 0;  // y = 0
+    double highWall = 0; // y = height
+};
+
+// The same movement, also adding the momentum each wall received to wallImpulses. A molecule hitting
+// the far wall of an axis several times within one step while the left wall moves is counted as if
+// it kept its speed between these hits; the sum of both walls of an axis is exact in every case.
+// Movement stays bit-identical to the overload above, the impulse sums only differ between kernels
+// in rounding.
+void integrateBoxMovement
+(
+    double *xs, double *ys, double *speedXs, double *speedYs, const int *masses, const size_t moleculesCnt,
+    const double leftWallX, const double rightWallX, const double height, const double leftWallSpeed,
+    const double deltaSecs, BoxWallImpulses &wallImpulses, const SimdIsa isa=getBestSimdIsa()
+);
+
+#endif // BOX_INTEGRATOR_H
@@ -0,0 +1,24 @@
+#ifndef CORE_METRICS_H
+#define CORE_METRICS_H
+
+#include "spsc_ring.h"
+
+#include <cstddef>
+
+// a few seconds of ticks even at high time scales, drained by the GUI every frame
+static const size_t CORE_METRICS_RING_CAPACITY = 4096;
+
+// Macroscopic state of the core after one step, for live plots.
+struct CoreMetricsSample {
+    double timePoint = 0;
+
+    size_t circlitsCnt = 0;
+    size_t quadritsCnt = 0;
+
+    double kineticEnergy = 0;
+    double pressure = 0; // momentum the walls take per unit length per second, see CoreObservables
+};
+
+typedef SpscRing<CoreMetricsSample, CORE_METRICS_RING_CAPACITY> CoreMetricsRing;
+
+#endif // CORE_METRICS_H
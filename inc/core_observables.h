@@ -0,0 +1,105 @@
+#ifndef CORE_OBSERVABLES_H
+#define CORE_OBSERVABLES_H
+
+#include "box_integrator.h"
+#include "molecule_store.h"
+
+#include <cstddef>
+
+enum WallType {
+    NONE_WALL = -1,
+
+    UPPER_WALL = 0,
+    LEFT_WALL = 1,
+    LOWER_WALL = 2,
+    RIGHT_WALL = 3,
+};
+
+static const size_t WALLS_CNT = 4;
+
+// pressures are averaged over about this much simulated time, a single step is mostly noise
+static const double CORE_PRESSURE_AVERAGING_SECS = 1;
+
+// Thermodynamic state of the core as running aggregates. The core reports every event that changes
+// them: spawns, reactions (which kill their reactants and spawn products) and wall hits, so no query
+// ever rescans the molecules and every getter is O(1). Temperature is in units with k_B = 1.
+class CoreObservables {
+    size_t moleculeTypeCnts[MOLECULE_TYPES_CNT];
+    double totalMass;
+    double doubledKineticEnergy; // sum of m v^2
+    double momentumX;
+    double momentumY;
+
+    // momentum every wall took along its outward normal
+    double stepWallImpulses[WALLS_CNT]; // since the last finishStep
+    double wallImpulses[WALLS_CNT];     // since the last recount
+
+    double averagedSecs;
+    double wallPressures[WALLS_CNT];
+    double pressure;
+
+public:
+    CoreObservables() { reset(); }
+
+    // Rescans the store from scratch, for when molecules were replaced wholesale, e.g. by a
+    // snapshot load. Impulses and pressures start over.
+    void recount(const MoleculeStore &moleculeStore);
+
+    // Rescans only counts, mass, kinetic energy and momentum, keeping impulses and pressures. The
+    // running sums lose the small terms whenever a very fast molecule comes and goes, so the core
+    // re-anchors them each time compaction walks the store anyway.
+    void recountMolecules(const MoleculeStore &moleculeStore);
+
+    void addMolecule(const MoleculeStore &moleculeStore, const size_t moleculeIndex) {
+        accountMolecule(moleculeStore, moleculeIndex, /*sign=*/1);
+    }
+
+    void removeMolecule(const MoleculeStore &moleculeStore, const size_t moleculeIndex) {
+        accountMolecule(moleculeStore, moleculeIndex, /*sign=*/-1);
+    }
+
+    // molecules [firstIndex, endIndex)
+    void addMolecules(const MoleculeStore &moleculeStore, const size_t firstIndex, const size_t endIndex) {
+        for (size_t moleculeIndex = firstIndex; moleculeIndex < endIndex; moleculeIndex++)
+            addMolecule(moleculeStore, moleculeIndex);
+    }
+
+    // a molecule of mass bounced off wallType, changing its speed from speedVector to newSpeedVector
+    void addWallHit
+    (
+        const WallType wallType, const int mass,
+        const gm_vector<double, 2> &speedVector, const gm_vector<double, 2> &newSpeedVector
+    );
+
+    // wall hits of one integrateBoxMovement call whose left wall moved at leftWallSpeed
+    void addBoxWallImpulses(const BoxWallImpulses &boxWallImpulses, const double leftWallSpeed);
+
+    // Turns the impulses the walls took during the step into pressures: momentum per unit of wall
+    // length per second, averaged over CORE_PRESSURE_AVERAGING_SECS.
+    void finishStep(const double deltaSecs, const double boxWidth, const double boxHeight);
+
+    size_t getMoleculesCnt() const;
+    size_t getMoleculesCnt(const MoleculeTypes moleculeType) const { return moleculeTypeCnts[moleculeType]; }
+
+    double getTotalMass() const { return totalMass; }
+    double getKineticEnergy() const { return doubledKineticEnergy / 2; }
+    gm_vector<double, 2> getMomentum() const { return gm_vector<double, 2>(momentumX, momentumY); }
+
+    // ideal 2D gas, two degrees of freedom per molecule: kinetic energy = N k_B T
+    double getTemperature() const {
+        size_t moleculesCnt = getMoleculesCnt();
+        return (moleculesCnt > 0) ? getKineticEnergy() / moleculesCnt : 0;
+    }
+
+    double getWallImpulse(const WallType wallType) const { return wallImpulses[wallType]; }
+    double getWallPressure(const WallType wallType) const { return wallPressures[wallType]; }
+    // over the whole perimeter of the box
+    double getPressure() const { return pressure; }
+
+private:
+    void reset();
+    void resetMolecules();
+    void accountMolecule(const MoleculeStore &moleculeStore, const size_t moleculeIndex, const int sign);
+};
+
+#endif // CORE_OBSERVABLES_H
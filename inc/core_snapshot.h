@@ -0,0 +1,52 @@
+#ifndef CORE_SNAPSHOT_H
+#define CORE_SNAPSHOT_H
+
+#include "molecule_store.h"
+
+#include <cstddef>
+#include <cstdint>
+
+static const uint64_t CORE_SNAPSHOT_MAGIC = 0x50414E5345524F43; // "CORESNAP" on little-endian hosts
+static const uint32_t CORE_SNAPSHOT_VERSION = 1;
+static const size_t CORE_SNAPSHOT_ALIGNMENT = MOLECULE_STORE_ALIGNMENT;
+
+// where one MoleculeStore array lies in the file
+struct CoreSnapshotArray {
+    uint64_t offset;
+    uint64_t length;
+    uint64_t elementSize;
+};
+
+// Snapshot file layout: this header, then every MoleculeStore array in forEachArray order, each
+// starting at a CORE_SNAPSHOT_ALIGNMENT-aligned offset. Everything is in host byte order, so a
+// file written on a host with other endianness fails the magic check. Any change to the header,
+// the arrays or their element types bumps CORE_SNAPSHOT_VERSION.
+struct CoreSnapshotHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+
+    uint64_t seed;
+    uint64_t randomDrawsCnt;
+    uint64_t spawnedMoleculesCnt;
+
+    double currentTime;
+    double cordSysWidth;
+    double cordSysHeight;
+    double pistonPosition;
+    double pistonTargetPosition;
+    double pistonSpeed;
+
+    uint32_t collisionDetectionMode;
+    uint32_t steppingMode;
+
+    uint64_t moleculesCnt;
+    CoreSnapshotArray arrays[MOLECULE_STORE_ARRAYS_CNT];
+};
+
+inline uint64_t alignCoreSnapshotOffset(const uint64_t offset) {
+    return (offset + CORE_SNAPSHOT_ALIGNMENT - 1) / CORE_SNAPSHOT_ALIGNMENT * CORE_SNAPSHOT_ALIGNMENT;
+}
+
+#endif // CORE_SNAPSHOT_H
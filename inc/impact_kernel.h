@@ -0,0 +1,23 @@
+#ifndef IMPACT_KERNEL_H
+#define IMPACT_KERNEL_H
+
+#include "simd_isa.h"
+
+#include <cstddef>
+#include <cstdint>
+
+static const size_t IMPACT_BATCH_MAX_SIZE = 64;
+
+// Times of impact of one moving collide circle against a block of candidates given in SoA form,
+// candidatesCnt <= IMPACT_BATCH_MAX_SIZE. impactDeltas[i] is the smaller root of
+// |P + V t| = r1 + r2 when it is non-negative, NaN otherwise; bit i of the result is set
+// when that root is within maxDelta. All kernels give bit-identical results.
+uint64_t computeImpactDeltas
+(
+    const double x, const double y, const double speedX, const double speedY, const double collideRadius,
+    const double *xs, const double *ys, const double *speedXs, const double *speedYs, const double *collideRadiuses,
+    const size_t candidatesCnt, const double maxDelta, double *impactDeltas,
+    const SimdIsa isa=getBestSimdIsa()
+);
+
+#endif // IMPACT_KERNEL_H
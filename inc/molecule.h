@@ -0,0 +1,117 @@
+#ifndef MOLECULE_H
+#define MOLECULE_H
+
+#include "gm_primitives.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+enum MoleculeTypes : int8_t {
+    NONE = -1,
+
+    CIRCLIT = 0,
+    QUADRIT = 1,
+};
+
+static const size_t MOLECULE_TYPES_CNT = 2;
+
+enum MoleculePhysicalStates : uint8_t {
+    DEATH,
+    UNRESPONSIVE,
+    ALIVE,
+};
+
+static const size_t MOLECULE_PHYSICAL_STATES_CNT = 3;
+
+enum ShapeType {
+    NONE_SHAPE_TYPE,
+
+    SQUARE,
+    CIRCLE,
+
+};
+
+static const double SQRT_2 = 1.41421356237;
+
+static const gm_vector<unsigned char, 3> CIRCLIT_COLOR(255, 0, 0);
+static const gm_vector<unsigned char, 3> QUADRIT_COLOR(0, 0, 255);
+
+static const double INITIAL_MASS = 1;
+static const double CIRCLIT_MIN_RADIUS = 1;
+
+// Molecule kinds are plain type tags: all per-molecule data lives in MoleculeStore,
+// the tags only know how shape parameters follow from the mass.
+// The exact shape is an axis-aligned square of half side boxHalfSide with corners rounded by
+// roundRadius; the collide circle bounds it.
+struct Circlit {
+    static const MoleculeTypes moleculeType = CIRCLIT;
+    static const ShapeType shapeType = ShapeType::CIRCLE;
+
+    static double getSize(const int mass) { return mass; } // temp formula: radius = mass
+    static double getCollideCircleRadius(const int mass) { return getSize(mass); }
+
+    static double getBoxHalfSide(const int) { return 0; }
+    static double getRoundRadius(const int mass) { return getSize(mass); }
+};
+
+struct Quadrit {
+    static const MoleculeTypes moleculeType = QUADRIT;
+    static const ShapeType shapeType = ShapeType::SQUARE;
+
+    static double getSize(const int mass) { return mass; } // temp formula: length = mass
+    static double getCollideCircleRadius(const int mass) { return getSize(mass) / SQRT_2; }
+
+    static double getBoxHalfSide(const int mass) { return getSize(mass) / 2; }
+    static double getRoundRadius(const int) { return 0; }
+};
+
+inline ShapeType getMoleculeShapeType(const MoleculeTypes moleculeType) {
+    switch (moleculeType) {
+        case CIRCLIT: return Circlit::shapeType;
+        case QUADRIT: return Quadrit::shapeType;
+        default: return ShapeType::NONE_SHAPE_TYPE;
+    }
+}
+
+inline double getMoleculeSize(const MoleculeTypes moleculeType, const int mass) {
+    switch (moleculeType) {
+        case CIRCLIT: return Circlit::getSize(mass);
+        case QUADRIT: return Quadrit::getSize(mass);
+        default: return 0;
+    }
+}
+
+inline double getMoleculeCollideCircleRadius(const MoleculeTypes moleculeType, const int mass) {
+    switch (moleculeType) {
+        case CIRCLIT: return Circlit::getCollideCircleRadius(mass);
+        case QUADRIT: return Quadrit::getCollideCircleRadius(mass);
+        default: return 0;
+    }
+}
+
+inline double getMoleculeBoxHalfSide(const MoleculeTypes moleculeType, const int mass) {
+    switch (moleculeType) {
+        case CIRCLIT: return Circlit::getBoxHalfSide(mass);
+        case QUADRIT: return Quadrit::getBoxHalfSide(mass);
+        default: return 0;
+    }
+}
+
+inline double getMoleculeRoundRadius(const MoleculeTypes moleculeType, const int mass) {
+    switch (moleculeType) {
+        case CIRCLIT: return Circlit::getRoundRadius(mass);
+        case QUADRIT: return Quadrit::getRoundRadius(mass);
+        default: return 0;
+    }
+}
+
+inline gm_vector<unsigned char, 3> getMoleculeColor(const MoleculeTypes moleculeType) {
+    switch (moleculeType) {
+        case CIRCLIT: return CIRCLIT_COLOR;
+        case QUADRIT: return QUADRIT_COLOR;
+        default: return gm_vector<unsigned char, 3>(0, 0, 0);
+    }
+}
+
+#endif // MOLECULE_H
@@ -0,0 +1,101 @@
+#ifndef MOLECULE_REACTIONS_H
+#define MOLECULE_REACTIONS_H
+
+#include "molecule_store.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+typedef void (*moleculeReaction) (
+    MoleculeStore &moleculeStore,
+    const size_t fstMoleculeIndex,
+    const size_t sndMoleculeIndex
+);
+
+void CirclitQuadritReaction(
+    MoleculeStore &moleculeStore,
+    const size_t fstMoleculeIndex,
+    const size_t sndMoleculeIndex
+);
+
+constexpr moleculeReaction CirclitCirclitReaction = CirclitQuadritReaction;
+
+void QuadritQuadritReaction(
+    MoleculeStore &moleculeStore,
+    const size_t fstMoleculeIndex,
+    const size_t sndMoleculeIndex
+);
+
+struct MoleculeReactionEntry {
+    MoleculeTypes fstMoleculeType;
+    MoleculeTypes sndMoleculeType;
+    moleculeReaction reaction;
+};
+
+// One entry per unordered pair of molecule types. Reactions take the molecules in collision
+// order, so an entry serves both (fst, snd) and (snd, fst).
+constexpr MoleculeReactionEntry moleculeReactionsRegistry[] = {
+    {CIRCLIT, CIRCLIT, CirclitCirclitReaction},
+    {CIRCLIT, QUADRIT, CirclitQuadritReaction},
+    {QUADRIT, QUADRIT, QuadritQuadritReaction},
+};
+
+static const size_t MOLECULE_REACTIONS_CNT = std::size(moleculeReactionsRegistry);
+
+constexpr size_t getMoleculeReactionKey(const MoleculeTypes fstMoleculeType, const MoleculeTypes sndMoleculeType) {
+    return (fstMoleculeType < sndMoleculeType) ? size_t(fstMoleculeType) * MOLECULE_TYPES_CNT + size_t(sndMoleculeType)
+                                               : size_t(sndMoleculeType) * MOLECULE_TYPES_CNT + size_t(fstMoleculeType);
+}
+
+// every pair of registered types has exactly one reaction
+constexpr bool isMoleculeReactionsRegistryComplete() {
+    size_t pairEntriesCnts[MOLECULE_TYPES_CNT * MOLECULE_TYPES_CNT] = {};
+
+    for (const MoleculeReactionEntry &entry : moleculeReactionsRegistry) {
+        if (entry.fstMoleculeType < 0 || size_t(entry.fstMoleculeType) >= MOLECULE_TYPES_CNT) return false;
+        if (entry.sndMoleculeType < 0 || size_t(entry.sndMoleculeType) >= MOLECULE_TYPES_CNT) return false;
+        if (entry.reaction == nullptr) return false;
+
+        pairEntriesCnts[getMoleculeReactionKey(entry.fstMoleculeType, entry.sndMoleculeType)]++;
+    }
+
+    for (size_t fst = 0; fst < MOLECULE_TYPES_CNT; fst++) {
+        for (size_t snd = fst; snd < MOLECULE_TYPES_CNT; snd++) {
+            if (pairEntriesCnts[fst * MOLECULE_TYPES_CNT + snd] != 1) return false;
+        }
+    }
+
+    return true;
+}
+
+static_assert(isMoleculeReactionsRegistryComplete(), "every pair of molecule types needs exactly one registered reaction");
+
+// Unrolls into a chain of key compares with direct calls, the registry itself never reaches memory.
+template <size_t... EntryIndices>
+inline void dispatchMoleculeReaction(
+    std::index_sequence<EntryIndices...>, const size_t reactionKey,
+    MoleculeStore &moleculeStore, const size_t fstMoleculeIndex, const size_t sndMoleculeIndex
+) {
+    bool isLaunched = ((reactionKey == getMoleculeReactionKey(moleculeReactionsRegistry[EntryIndices].fstMoleculeType,
+                                                              moleculeReactionsRegistry[EntryIndices].sndMoleculeType) &&
+                        (moleculeReactionsRegistry[EntryIndices].reaction(moleculeStore, fstMoleculeIndex, sndMoleculeIndex), true)) || ...);
+
+    assert(isLaunched && "molecule type outside of the reactions registry");
+    (void) isLaunched;
+}
+
+inline void launchMoleculeReaction (
+    MoleculeStore &moleculeStore,
+    const size_t fstMoleculeIndex,
+    const size_t sndMoleculeIndex
+) {
+    size_t reactionKey = getMoleculeReactionKey(moleculeStore.getMoleculeType(fstMoleculeIndex),
+                                                moleculeStore.getMoleculeType(sndMoleculeIndex));
+
+    dispatchMoleculeReaction(std::make_index_sequence<MOLECULE_REACTIONS_CNT>(), reactionKey,
+                             moleculeStore, fstMoleculeIndex, sndMoleculeIndex);
+}
+
+#endif // MOLECULE_REACTIONS_H
@@ -0,0 +1,396 @@
+#ifndef MOLECULE_STORE_H
+#define MOLECULE_STORE_H
+
+#include "molecule.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+static const size_t MOLECULE_STORE_ALIGNMENT = 64;
+
+// dead molecules are compacted by moving the survivors between them as blocks when there are
+// at least this many molecules per dead one on average, one by one otherwise
+static const size_t MOLECULE_STORE_MIN_BLOCK_MOVE_CNT = 16;
+
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+    AlignedAllocator() noexcept {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+    T *allocate(const size_t cnt) {
+        return static_cast<T *>(::operator new(cnt * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T *ptr, const size_t) noexcept {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T, MOLECULE_STORE_ALIGNMENT>>;
+
+typedef uint32_t MoleculeHandle;
+static const MoleculeHandle NONE_MOLECULE_HANDLE = std::numeric_limits<MoleculeHandle>::max();
+static const size_t NONE_MOLECULE_INDEX = std::numeric_limits<size_t>::max();
+static const size_t MOLECULE_STORE_ARRAYS_CNT = 11;
+static const size_t MOLECULE_STORE_PER_MOLECULE_ARRAYS_CNT = 9;
+
+// Structure-of-arrays molecule storage. Molecules are addressed by a dense index, which is
+// what the hot loops use, and by a handle, which stays valid while other molecules die.
+// Indices keep insertion order: new molecules are appended, dead ones are compacted out stably.
+class MoleculeStore {
+    AlignedVector<double> xs;
+    AlignedVector<double> ys;
+    AlignedVector<double> speedXs;
+    AlignedVector<double> speedYs;
+    AlignedVector<int> masses;
+    AlignedVector<double> collideRadiuses;
+    AlignedVector<MoleculeTypes> types;
+    AlignedVector<MoleculePhysicalStates> states;
+    AlignedVector<MoleculeHandle> handles;
+
+    std::vector<size_t> handleIndices;
+    std::vector<MoleculeHandle> freeHandles;
+
+public:
+    size_t size() const { return types.size(); }
+    bool empty() const { return types.empty(); }
+
+    void reserve(const size_t moleculesCnt) {
+        xs.reserve(moleculesCnt);
+        ys.reserve(moleculesCnt);
+        speedXs.reserve(moleculesCnt);
+        speedYs.reserve(moleculesCnt);
+        masses.reserve(moleculesCnt);
+        collideRadiuses.reserve(moleculesCnt);
+        types.reserve(moleculesCnt);
+        states.reserve(moleculesCnt);
+        handles.reserve(moleculesCnt);
+        handleIndices.reserve(moleculesCnt);
+        freeHandles.reserve(moleculesCnt);
+    }
+
+    size_t capacity() const { return types.capacity(); }
+
+    // Visits all MOLECULE_STORE_ARRAYS_CNT arrays in a fixed order, which is the order snapshots
+    // lay them out in: the per-molecule arrays, then handleIndices and freeHandles.
+    template <typename ArrayHandle>
+    void forEachArray(ArrayHandle &&arrayHandle) { forEachArrayOf(*this, arrayHandle); }
+    template <typename ArrayHandle>
+    void forEachArray(ArrayHandle &&arrayHandle) const { forEachArrayOf(*this, arrayHandle); }
+
+    // Whether the arrays describe a store this class could have built itself: known types and
+    // states, masses for the living, and handles, handleIndices and freeHandles mapping onto each
+    // other one to one. Meant for arrays that came from outside, e.g. a loaded snapshot.
+    bool isConsistent() const {
+        size_t moleculesCnt = size();
+        size_t handlesCnt = handleIndices.size();
+        if (handlesCnt != moleculesCnt + freeHandles.size() || handlesCnt > NONE_MOLECULE_HANDLE) return false;
+
+        for (size_t index = 0; index < moleculesCnt; index++) {
+            if (!(types[index] >= 0 && size_t(types[index]) < MOLECULE_TYPES_CNT)) return false;
+            if (size_t(states[index]) >= MOLECULE_PHYSICAL_STATES_CNT) return false;
+            if (states[index] != DEATH && masses[index] <= 0) return false;
+
+            // also makes the handles of the molecules distinct
+            if (handles[index] >= handlesCnt || handleIndices[handles[index]] != index) return false;
+        }
+
+        // the remaining handles must be exactly the free ones
+        std::vector<bool> isHandleFree(handlesCnt, false);
+        for (MoleculeHandle handle : freeHandles) {
+            if (handle >= handlesCnt || handleIndices[handle] != NONE_MOLECULE_INDEX || isHandleFree[handle]) return false;
+            isHandleFree[handle] = true;
+        }
+
+        return true;
+    }
+
+    void clear() {
+        xs.clear();
+        ys.clear();
+        speedXs.clear();
+        speedYs.clear();
+        masses.clear();
+        collideRadiuses.clear();
+        types.clear();
+        states.clear();
+        handles.clear();
+        handleIndices.clear();
+        freeHandles.clear();
+    }
+
+    MoleculeHandle addMolecule
+    (
+        const MoleculeTypes moleculeType,
+        const gm_vector<double, 2> &position,
+        const gm_vector<double, 2> &speedVector,
+        const int mass,
+        const MoleculePhysicalStates physicalState=ALIVE
+    ) {
+        MoleculeHandle handle = NONE_MOLECULE_HANDLE;
+        if (freeHandles.empty()) {
+            handle = MoleculeHandle(handleIndices.size());
+            handleIndices.push_back(size());
+        } else {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+            handleIndices[handle] = size();
+        }
+
+        xs.push_back(position.get_x());
+        ys.push_back(position.get_y());
+        speedXs.push_back(speedVector.get_x());
+        speedYs.push_back(speedVector.get_y());
+        masses.push_back(mass);
+        collideRadiuses.push_back(getMoleculeCollideCircleRadius(moleculeType, mass));
+        types.push_back(moleculeType);
+        states.push_back(physicalState);
+        handles.push_back(handle);
+
+        return handle;
+    }
+
+    // Appends moleculesCnt molecules of one kind at the origin with zero speed and returns the
+    // index of the first one; callers fill positions and speeds through the array getters.
+    size_t appendMolecules
+    (
+        const MoleculeTypes moleculeType, const size_t moleculesCnt, const int mass,
+        const MoleculePhysicalStates physicalState=ALIVE
+    ) {
+        size_t firstIndex = size();
+        size_t newSize = firstIndex + moleculesCnt;
+
+        xs.resize(newSize, 0);
+        ys.resize(newSize, 0);
+        speedXs.resize(newSize, 0);
+        speedYs.resize(newSize, 0);
+        masses.resize(newSize, mass);
+        collideRadiuses.resize(newSize, getMoleculeCollideCircleRadius(moleculeType, mass));
+        types.resize(newSize, moleculeType);
+        states.resize(newSize, physicalState);
+        handles.resize(newSize);
+
+        for (size_t index = firstIndex; index < newSize; index++) {
+            if (freeHandles.empty()) {
+                handles[index] = MoleculeHandle(handleIndices.size());
+                handleIndices.push_back(index);
+            } else {
+                handles[index] = freeHandles.back();
+                freeHandles.pop_back();
+                handleIndices[handles[index]] = index;
+            }
+        }
+
+        return firstIndex;
+    }
+
+    // Stable compaction: drops DEATH molecules, wakes UNRESPONSIVE ones and remaps handles. Dead ones
+    // are only dropped when they are more than minDeadShare of the store, otherwise they wait for a
+    // later call. The scan of the states is branch-free, so a call finding no dead costs one pass
+    // over a byte per molecule. Returns whether dead molecules were dropped.
+    bool removeDeadMolecules(const double minDeadShare=0) {
+        size_t moleculesCnt = size();
+        size_t deadCnt = 0;
+
+        for (size_t i = 0; i < moleculesCnt; i++) {
+            deadCnt += states[i] == DEATH;
+            states[i] = (states[i] == UNRESPONSIVE) ? ALIVE : states[i];
+        }
+
+        if (deadCnt == 0 || double(deadCnt) <= minDeadShare * double(moleculesCnt)) return false;
+
+        // molecules before the first dead one stay in place
+        size_t firstDeadIndex = std::find(states.begin(), states.end(), DEATH) - states.begin();
+        bool isDeadSparse = moleculesCnt - firstDeadIndex >= deadCnt * MOLECULE_STORE_MIN_BLOCK_MOVE_CNT;
+
+        size_t aliveCnt = isDeadSparse ? compactSurvivorRuns(firstDeadIndex) : compactSurvivors(firstDeadIndex);
+        resize(aliveCnt);
+        return true;
+    }
+
+    // A molecule killed while compaction is deferred stays in the arrays for a while: with no mass
+    // and speed it neither moves on its own nor hands momentum to the walls, and with no collide
+    // radius it neither widens grid cells nor fattens sweep-and-prune intervals and tree boxes.
+    void freezeDeadMolecule(const size_t index) {
+        assert(states[index] == DEATH);
+
+        speedXs[index] = 0;
+        speedYs[index] = 0;
+        masses[index] = 0;
+        collideRadiuses[index] = 0;
+    }
+
+    size_t getIndex(const MoleculeHandle handle) const {
+        assert(handle < handleIndices.size());
+        return handleIndices[handle];
+    }
+    MoleculeHandle getHandle(const size_t index) const { return handles[index]; }
+
+    gm_vector<double, 2> getPosition(const size_t index) const { return gm_vector<double, 2>(xs[index], ys[index]); }
+    gm_vector<double, 2> getSpeedVector(const size_t index) const { return gm_vector<double, 2>(speedXs[index], speedYs[index]); }
+    int getMass(const size_t index) const { return masses[index]; }
+    double getCollideCircleRadius(const size_t index) const { return collideRadiuses[index]; }
+    MoleculeTypes getMoleculeType(const size_t index) const { return types[index]; }
+    MoleculePhysicalStates getPhysicalState(const size_t index) const { return states[index]; }
+
+    ShapeType getShapeType(const size_t index) const { return getMoleculeShapeType(types[index]); }
+    double getSize(const size_t index) const { return getMoleculeSize(types[index], masses[index]); }
+    double getBoxHalfSide(const size_t index) const { return getMoleculeBoxHalfSide(types[index], masses[index]); }
+    double getRoundRadius(const size_t index) const { return getMoleculeRoundRadius(types[index], masses[index]); }
+    gm_vector<unsigned char, 3> getColor(const size_t index) const { return getMoleculeColor(types[index]); }
+
+    void setPosition(const size_t index, const gm_vector<double, 2> &newPosition) {
+        xs[index] = newPosition.get_x();
+        ys[index] = newPosition.get_y();
+    }
+
+    void setSpeedVector(const size_t index, const gm_vector<double, 2> &newSpeedVector) {
+        speedXs[index] = newSpeedVector.get_x();
+        speedYs[index] = newSpeedVector.get_y();
+    }
+
+    void setPhysicalState(const size_t index, const MoleculePhysicalStates state) { states[index] = state; }
+
+    const double *getXs() const { return xs.data(); }
+    const double *getYs() const { return ys.data(); }
+    const double *getSpeedXs() const { return speedXs.data(); }
+    const double *getSpeedYs() const { return speedYs.data(); }
+    const int *getMasses() const { return masses.data(); }
+    const double *getCollideRadiuses() const { return collideRadiuses.data(); }
+    const MoleculeTypes *getMoleculeTypes() const { return types.data(); }
+    const MoleculePhysicalStates *getPhysicalStates() const { return states.data(); }
+    const MoleculeHandle *getHandles() const { return handles.data(); }
+
+    double *getXs() { return xs.data(); }
+    double *getYs() { return ys.data(); }
+    double *getSpeedXs() { return speedXs.data(); }
+    double *getSpeedYs() { return speedYs.data(); }
+
+private:
+    template <typename Store, typename ArrayHandle>
+    static void forEachArrayOf(Store &store, ArrayHandle &arrayHandle) {
+        arrayHandle(store.xs);
+        arrayHandle(store.ys);
+        arrayHandle(store.speedXs);
+        arrayHandle(store.speedYs);
+        arrayHandle(store.masses);
+        arrayHandle(store.collideRadiuses);
+        arrayHandle(store.types);
+        arrayHandle(store.states);
+        arrayHandle(store.handles);
+        arrayHandle(store.handleIndices);
+        arrayHandle(store.freeHandles);
+    }
+
+    // Survivors between two dead molecules are moved as one block, with a memmove per array.
+    // Returns the survivors count.
+    size_t compactSurvivorRuns(const size_t firstDeadIndex) {
+        size_t moleculesCnt = size();
+        size_t deadIndex = firstDeadIndex;
+        size_t aliveCnt = firstDeadIndex;
+
+        while (deadIndex < moleculesCnt) {
+            handleIndices[handles[deadIndex]] = NONE_MOLECULE_INDEX;
+            freeHandles.push_back(handles[deadIndex]);
+
+            size_t runBegin = deadIndex + 1;
+            size_t runEnd = std::find(states.begin() + runBegin, states.end(), DEATH) - states.begin();
+
+            auto moveRun = [=](auto &array) {
+                std::copy(array.begin() + runBegin, array.begin() + runEnd, array.begin() + aliveCnt);
+            };
+
+            moveRun(xs);
+            moveRun(ys);
+            moveRun(speedXs);
+            moveRun(speedYs);
+            moveRun(masses);
+            moveRun(collideRadiuses);
+            moveRun(types);
+            moveRun(states);
+            moveRun(handles);
+
+            for (size_t index = runBegin; index < runEnd; index++)
+                handleIndices[handles[aliveCnt + (index - runBegin)]] = aliveCnt + (index - runBegin);
+
+            aliveCnt += runEnd - runBegin;
+            deadIndex = runEnd;
+        }
+
+        return aliveCnt;
+    }
+
+    // For dead molecules too dense for block moves: survivors are copied one by one, dead ones
+    // are skipped without touching their data. Returns the survivors count.
+    size_t compactSurvivors(const size_t firstDeadIndex) {
+        size_t moleculesCnt = size();
+
+        // Local pointers: the one byte types and states may alias anything, so stores through the
+        // members would reload every array's data pointer on each molecule.
+        double *xsData = xs.data();
+        double *ysData = ys.data();
+        double *speedXsData = speedXs.data();
+        double *speedYsData = speedYs.data();
+        int *massesData = masses.data();
+        double *collideRadiusesData = collideRadiuses.data();
+        MoleculeTypes *typesData = types.data();
+        MoleculePhysicalStates *statesData = states.data();
+        MoleculeHandle *handlesData = handles.data();
+        size_t *handleIndicesData = handleIndices.data();
+
+        size_t aliveCnt = firstDeadIndex;
+        for (size_t i = firstDeadIndex; i < moleculesCnt; i++) {
+            MoleculeHandle handle = handlesData[i];
+
+            if (statesData[i] == DEATH) {
+                handleIndicesData[handle] = NONE_MOLECULE_INDEX;
+                freeHandles.push_back(handle);
+                continue;
+            }
+
+            xsData[aliveCnt] = xsData[i];
+            ysData[aliveCnt] = ysData[i];
+            speedXsData[aliveCnt] = speedXsData[i];
+            speedYsData[aliveCnt] = speedYsData[i];
+            massesData[aliveCnt] = massesData[i];
+            collideRadiusesData[aliveCnt] = collideRadiusesData[i];
+            typesData[aliveCnt] = typesData[i];
+            statesData[aliveCnt] = statesData[i];
+            handlesData[aliveCnt] = handle;
+
+            handleIndicesData[handle] = aliveCnt++;
+        }
+
+        return aliveCnt;
+    }
+
+    void resize(const size_t moleculesCnt) {
+        xs.resize(moleculesCnt);
+        ys.resize(moleculesCnt);
+        speedXs.resize(moleculesCnt);
+        speedYs.resize(moleculesCnt);
+        masses.resize(moleculesCnt);
+        collideRadiuses.resize(moleculesCnt);
+        types.resize(moleculesCnt);
+        states.resize(moleculesCnt);
+        handles.resize(moleculesCnt);
+    }
+};
+
+#endif // MOLECULE_STORE_H
@@ -0,0 +1,70 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+static const size_t PHILOX_ROUNDS_CNT = 10;
+static const size_t PHILOX_BLOCK_WORDS_CNT = 4;
+static const size_t PHILOX_BLOCK_UNIFORMS_CNT = PHILOX_BLOCK_WORDS_CNT / 2;
+
+// Counter-based Philox4x32-10 generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// Output is a pure function of (seed, stream, counter): any number can be computed independently,
+// so streams can be consumed in parallel, in batches or out of order with identical results.
+class PhiloxRandom {
+    uint64_t seed;
+
+public:
+    typedef std::array<uint32_t, PHILOX_BLOCK_WORDS_CNT> Block;
+
+    explicit PhiloxRandom(const uint64_t seed=0): seed(seed) {}
+
+    void setSeed(const uint64_t newSeed) { seed = newSeed; }
+    uint64_t getSeed() const { return seed; }
+
+    Block generateBlock(const uint64_t streamIndex, const uint64_t blockIndex) const {
+        Block counter = {uint32_t(blockIndex), uint32_t(blockIndex >> 32), uint32_t(streamIndex), uint32_t(streamIndex >> 32)};
+        uint32_t key0 = uint32_t(seed);
+        uint32_t key1 = uint32_t(seed >> 32);
+
+        for (size_t round = 0; round < PHILOX_ROUNDS_CNT; round++) {
+            uint64_t product0 = uint64_t(PHILOX_M0) * counter[0];
+            uint64_t product1 = uint64_t(PHILOX_M1) * counter[2];
+
+            counter = {uint32_t(product1 >> 32) ^ counter[1] ^ key0, uint32_t(product1),
+                       uint32_t(product0 >> 32) ^ counter[3] ^ key1, uint32_t(product0)};
+
+            key0 += PHILOX_W0;
+            key1 += PHILOX_W1;
+        }
+
+        return counter;
+    }
+
+    // uniform in [0, 1) with 53 random bits, built from two words of a block
+    static double toUnitDouble(const uint32_t hiWord, const uint32_t loWord) {
+        return double(((uint64_t(hiWord) << 32) | loWord) >> 11) * 0x1.0p-53;
+    }
+
+    // uniforms number firstUniformIndex, firstUniformIndex + 1, ... of the stream
+    void generateUniforms(const uint64_t streamIndex, const uint64_t firstUniformIndex, double *uniforms, const size_t uniformsCnt) const {
+        uint64_t uniformIndex = firstUniformIndex;
+        size_t i = 0;
+
+        while (i < uniformsCnt) {
+            Block block = generateBlock(streamIndex, uniformIndex / PHILOX_BLOCK_UNIFORMS_CNT);
+
+            for (size_t word = (uniformIndex % PHILOX_BLOCK_UNIFORMS_CNT) * 2; word < PHILOX_BLOCK_WORDS_CNT && i < uniformsCnt; word += 2) {
+                uniforms[i++] = toUnitDouble(block[word], block[word + 1]);
+                uniformIndex++;
+            }
+        }
+    }
+};
+
+#endif // PHILOX_H
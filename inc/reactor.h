@@ -12,7 +12,8 @@
 #include <QPushButton>
 
 #include <algorithm>
-#include "reactorcore.h"
+#include <vector>
+#include "reactorcore_adapter.h"
 
 static const int PISTON_SLIDER_MINVAL = 10;
 static const int PISTON_SLIDER_MAXVAL = 80;
@@ -20,6 +21,14 @@ static const int PISTON_SLIDER_STRETCH_FACTOR = 1;
 static const int REACTOR_CANVAS_STRETCH_FACTOR = 4;
 static const int MOLECULE_BUTTONS_STRETCH_FACTOR = 1;
 static const double CORE_CORD_SYSTEM_SCALE = 10;
+static const size_t ANTIALIASED_MOLECULES_MAX_CNT = 5000;
+
+// molecules sharing shape and colour, painted with one brush in one go
+struct MoleculeBatch {
+    ShapeType shapeType;
+    uint32_t color;
+    std::vector<QRectF> moleculeRects;
+};
 
 
 class ReactorCanvas : public QWidget {
@@ -33,7 +42,10 @@ class ReactorCanvas : public QWidget {
     QRect pistonRectangle;
     QRect coreRectangle;
 
-    const ReactorCore *reactorCore;
+    ReactorCoreAdapter *reactorCore;
+
+    // kept between frames, so batching stops allocating once every batch has grown
+    std::vector<MoleculeBatch> moleculeBatches;
 
 public:
     explicit ReactorCanvas
@@ -42,7 +54,7 @@ public:
         const QString &coreTexturePath,
         const QRect &pistonRectangle,
         const QRect &coreRectangle,
-        const ReactorCore *reactorCore,
+        ReactorCoreAdapter *reactorCore,
         QWidget *parent = nullptr
     ) : 
         reactorCoreTexture(coreTexturePath), 
@@ -61,45 +73,82 @@ private:
         update();
     }
 
+    size_t findMoleculeBatch(const ShapeType shapeType, const uint32_t color) {
+        for (size_t batchIndex = 0; batchIndex < moleculeBatches.size(); batchIndex++) {
+            if (moleculeBatches[batchIndex].shapeType == shapeType && moleculeBatches[batchIndex].color == color)
+                return batchIndex;
+        }
+
+        moleculeBatches.push_back({shapeType, color, {}});
+        return moleculeBatches.size() - 1;
+    }
+
+    void batchMolecules(const RenderSnapshot &snapshot) {
+        for (MoleculeBatch &batch : moleculeBatches)
+            batch.moleculeRects.clear();
+
+        const gm_vector<double, 2> &coreCanvasPos = reactorCore->getCoreCanvasPos();
+        double coreCordSystemScale = reactorCore->getCoreCordSystemScale();
+
+        // neighbouring molecules mostly share a batch, so the last one is tried first
+        size_t batchIndex = 0;
+        for (size_t moleculeIndex = 0; moleculeIndex < snapshot.size(); moleculeIndex++) {
+            ShapeType shapeType = snapshot.shapeTypes[moleculeIndex];
+            uint32_t color = snapshot.colors[moleculeIndex];
+
+            if (batchIndex >= moleculeBatches.size() ||
+                moleculeBatches[batchIndex].shapeType != shapeType || moleculeBatches[batchIndex].color != color)
+                batchIndex = findMoleculeBatch(shapeType, color);
+
+            double canvasX = coreCanvasPos.get_x() + snapshot.xs[moleculeIndex] * coreCordSystemScale;
+            double canvasY = coreCanvasPos.get_y() + snapshot.ys[moleculeIndex] * coreCordSystemScale;
+            double moleculeSize = snapshot.sizes[moleculeIndex] * coreCordSystemScale;
+
+            // squares are moleculeSize wide, circles have moleculeSize radius
+            double halfExtent = (shapeType == ShapeType::SQUARE) ? moleculeSize / 2 : moleculeSize;
+            moleculeBatches[batchIndex].moleculeRects.emplace_back(canvasX - halfExtent, canvasY - halfExtent, 2 * halfExtent, 2 * halfExtent);
+        }
+    }
+
 protected:
     void paintEvent(QPaintEvent *) override {
         QPainter painter(this);
-        painter.setRenderHint(QPainter::Antialiasing);
 
-        painter.drawPixmap(pistonRectangle, reactorPistonTexture);
-        painter.drawPixmap(coreRectangle, reactorCoreTexture);
+        const RenderSnapshot &snapshot = reactorCore->acquireRenderSnapshot();
 
+        // the piston is drawn where the core has moved it, which lags behind the slider
+        QRect reactorRectangle = pistonRectangle.united(coreRectangle);
+        int pistonCanvasX = reactorCore->convertMoleculeCords({snapshot.pistonPosition, 0}).get_x();
+        pistonCanvasX = std::min(std::max(pistonCanvasX, reactorRectangle.left()), reactorRectangle.left() + reactorRectangle.width());
 
-        for (auto moleculeIT = reactorCore->getMoleculeList().begin(); moleculeIT != reactorCore->getMoleculeList().end(); ++moleculeIT) {
-            Molecule *moleculePtr = (*moleculeIT).get();
+        painter.drawPixmap(QRect(reactorRectangle.topLeft(), QPoint(pistonCanvasX - 1, reactorRectangle.bottom())), reactorPistonTexture);
+        painter.drawPixmap(QRect(QPoint(pistonCanvasX, reactorRectangle.top()), reactorRectangle.bottomRight()), reactorCoreTexture);
 
-            ShapeType shapeType = moleculePtr->getShapeType();
-            double moleculeSize = moleculePtr->getSize() * CORE_CORD_SYSTEM_SCALE;
-            QColor moleculeColor = QColor(moleculePtr->getColor().get_x(), moleculePtr->getColor().get_y(), moleculePtr->getColor().get_z());
-            gm_vector<int, 2> moleculeCanvasPos = reactorCore->convertMoleculeCords(moleculePtr->getPosition());
 
+        // aliased shapes take the raster engine span-fill fast paths, antialiasing is
+        // only affordable while molecules are few
+        painter.setRenderHint(QPainter::Antialiasing, snapshot.size() <= ANTIALIASED_MOLECULES_MAX_CNT);
+        painter.setPen(Qt::NoPen);
 
-            painter.setBrush(moleculeColor);
-            painter.setPen(Qt::NoPen); 
-            
-            switch (shapeType) {
-                case ShapeType::SQUARE:
+        batchMolecules(snapshot);
+        for (const MoleculeBatch &batch : moleculeBatches) {
+            if (batch.moleculeRects.empty()) continue;
 
-                    painter.drawRect
-                    (
-                        moleculeCanvasPos.get_x() - moleculeSize / 2, 
-                        moleculeCanvasPos.get_y() - moleculeSize / 2,
-                        moleculeSize,
-                        moleculeSize
-                    );
-        
+            painter.setBrush(QColor(QRgb(batch.color)));
+
+            switch (batch.shapeType) {
+                case ShapeType::SQUARE:
+                    painter.drawRects(batch.moleculeRects.data(), int(batch.moleculeRects.size()));
                     break;
+
                 case ShapeType::CIRCLE:
-                    painter.drawEllipse(QPointF(moleculeCanvasPos.get_x(), moleculeCanvasPos.get_y()), moleculeSize, moleculeSize);
+                    // QPainter has no multi-ellipse call, the batch still shares one brush
+                    for (const QRectF &moleculeRect : batch.moleculeRects)
+                        painter.drawEllipse(moleculeRect);
                     break;
 
                 default:
-                    qWarning() << QString("Can't paint molecule shape`%1`").arg(shapeType);
+                    qWarning() << QString("Can't paint molecule shape`%1`").arg(batch.shapeType);
                     break;
             }
         }
@@ -123,7 +172,7 @@ class Reactor : public QFrame {
     QRect coreRectangle;
 
     ReactorCanvas *reactorCanvas;
-    ReactorCore   *reactorCore;
+    ReactorCoreAdapter *reactorCore;
     
     
 public:
@@ -146,7 +195,7 @@ public:
         reactorLayout->addWidget(pistonSlider, sliderStretchFactor);
     }
 
-    void addReactorCoreButtons(QVBoxLayout *reactorLayout, ReactorCore *reactorCore, const int buttonStretchFactor) {
+    void addReactorCoreButtons(QVBoxLayout *reactorLayout, ReactorCoreAdapter *reactorCore, const int buttonStretchFactor) {
         assert(reactorLayout);
         assert(reactorCore);
 
@@ -174,8 +223,8 @@ public:
         auto *reactorLayout = new QVBoxLayout(this);
         reactorLayout->setContentsMargins(borderSize, borderSize, borderSize, borderSize);
 
-        reactorCore = new ReactorCore(coreRectangle, CORE_CORD_SYSTEM_SCALE, this);
-        connect(reactorCore, &ReactorCore::reactorCoreUpdated, this, &Reactor::reactorUpdate);
+        reactorCore = new ReactorCoreAdapter(coreRectangle, CORE_CORD_SYSTEM_SCALE, this);
+        connect(reactorCore, &ReactorCoreAdapter::reactorCoreUpdated, this, &Reactor::reactorUpdate);
 
         reactorCanvas = new ReactorCanvas(pistonTexturePath, coreTexturePath, pistonRectangle, coreRectangle, reactorCore, this);
         reactorCanvas->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -187,7 +236,8 @@ public:
         setPistonPercentage(PISTON_SLIDER_MINVAL);
     }
 
-    
+    ReactorCoreAdapter *getReactorCoreAdapter() const { return reactorCore; }
+
 signals:
     void pistonPercentageChanged(int value);
 
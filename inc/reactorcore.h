@@ -1,272 +1,201 @@
 #ifndef REACTORCORE_H
 #define REACTORCORE_H
 
-#include <QApplication>
-#include <QMainWindow>
-#include <QWidget>
-#include <QTimer>
-
+#include "aabb_tree.h"
+#include "box_integrator.h"
+#include "core_metrics.h"
+#include "core_observables.h"
+#include "core_snapshot.h"
 #include "gm_primitives.hpp"
-#include <list>
-#include <typeinfo>
+#include "impact_kernel.h"
+#include "molecule_reactions.h"
+#include "molecule_store.h"
+#include "philox.h"
+#include "render_snapshot.h"
+#include "spatial_grid.h"
+#include "sweep_and_prune.h"
+#include "trajectory_recorder.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cstdint>
 #include <cstring>
 #include <numbers>
 #include <random>
+#include <string>
+#include <tuple>
+
+enum CollisionDetectionMode {
+    BRUTE_FORCE_DETECTION,
+    UNIFORM_GRID_DETECTION,
+    SWEEP_AND_PRUNE_DETECTION,
+    AABB_TREE_DETECTION,
+};
 
-enum MoleculeTypes {
-    NONE = -1,
+static const size_t COLLISION_DETECTION_MODES_CNT = 4;
 
-    CIRCLIT = 0,
-    QUADRIT = 1,    
+enum SpawnDistribution {
+    UNIFORM_SPAWN,
+    POISSON_DISK_SPAWN,
 };
 
-enum MoleculePhysicalStates {
-    DEATH,
-    UNRESPONSIVE,
-    ALIVE,
+enum SteppingMode {
+    FIXED_STEP_MODE,
+    EVENT_DRIVEN_MODE,
+    ADAPTIVE_STEP_MODE,
 };
 
+static const size_t STEPPING_MODES_CNT = 3;
+
 static const double DISTANCE_COLLISION_EPS = 0.1;
 static const double DISTANCE_COLLISION_EPS2 = DISTANCE_COLLISION_EPS * DISTANCE_COLLISION_EPS;
 static const double TIME_COLLISION_EPS = 0.01;
 
-static const double SQRT_2 = 1.41421356237;
+// fixed-step movement runs over chunks of this many molecules, on the worker threads if any
+static const size_t BOX_IMPULSE_CHUNK_MOLECULES_CNT = 1024;
+
 static const double MS_IN_S = 1000;
 static const double REACTOR_CORE_UPDATE_SECS = 0.016;
 static const size_t MAX_CLASS_NAME_LEN = 10;
 
-static const gm_vector<unsigned char, 3> CIRCLIT_COLOR(255, 0, 0);
-static const gm_vector<unsigned char, 3> QUADRIT_COLOR(0, 0, 255);
-
 static const double MoleculeMinInitSpeed = 1;
 static const double MoleculeMaxInitSpeed = 3;
 
 static const gm_vector<double, 2> INITIAL_speedVector(1, 1);
-static const double INITIAL_MASS = 1;
-static const double CIRCLIT_MIN_RADIUS = 1;
-// static const double INITIAL_CIRCLIT_RADIUS = 1;
-// static const double INITIAL_QUADRIT_LENGTH = 1;
-
-enum ShapeType {
-    NONE_SHAPE_TYPE,
-
-    SQUARE,
-    CIRCLE,
-    
-};
-
-
-class Molecule;
-
-typedef void (*moleculeReaction) (
-    std::list<std::unique_ptr<Molecule>> &moleculeList,
-    std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-    std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT
-);
-
-void CirclitQuadritReaction(
-    std::list<std::unique_ptr<Molecule>> &moleculeList,
-    std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-    std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT
-);
-
-const moleculeReaction CirclitCirclitReaction = CirclitQuadritReaction;
-
-void QuadritQuadritReaction(
-    std::list<std::unique_ptr<Molecule>> &moleculeList,
-    std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-    std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT
-);
-
-void launchMoleculeReaction (
-    std::list<std::unique_ptr<Molecule>> &moleculeList,
-    std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-    std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT 
-);
-
-
-const size_t moleculeReactionsVTableMaxSz = 100;
-const moleculeReaction moleculeReactionsVTable[moleculeReactionsVTableMaxSz][moleculeReactionsVTableMaxSz] = 
-{
-    {/*[0:CIRCLIT][0:CIRCLIT]=*/CirclitCirclitReaction, /*[0:CIRCLIT][1:QUADRIT]=*/ CirclitQuadritReaction},
-    {/*[1:QUADRIT][0:CIRCLIT]=*/CirclitQuadritReaction, /*[1:QUADRIT][1:QUADRIT]=*/ QuadritQuadritReaction}
-};
-
-
-
-
-class Molecule {
-    MoleculeTypes moleculeType;
-    MoleculePhysicalStates moleculePhysicalState;
-
-    gm_vector<double, 2> position;
-    gm_vector<double, 2> speedVector;
-    int mass;
-
-    gm_vector<unsigned char, 3> color;
-
-    friend class Circlit;
-    friend class Quadrit;
-    friend void launchMoleculeReaction(
-        std::list<std::unique_ptr<Molecule>> &moleculeList,
-        std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-        std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT);
-
-private:
-    Molecule
-    (
-        const gm_vector<double, 2> &position, 
-        const gm_vector<double, 2> &speedVector, 
-        const int mass,
-        const gm_vector<unsigned char, 3> &color
-    ):
-        position(position),
-        speedVector(speedVector),
-        mass(mass),
-        color(color)
-    {
-        moleculeType = NONE;
-        moleculePhysicalState = ALIVE;
-    };
-    
-
-public:
-    virtual ~Molecule() {};
 
-    virtual ShapeType getShapeType() const { return ShapeType::NONE_SHAPE_TYPE; };
-    virtual double getSize() const { return 0; };
-    virtual double getCollideCircleRadius() const { return 0; }
+// molecule spawned k-th since the seed was set draws its initial state from Philox stream k,
+// randRange draws from the dedicated stream below
+static const uint64_t REACTOR_CORE_RANDOM_STREAM = std::numeric_limits<uint64_t>::max();
+static const size_t MOLECULE_INIT_UNIFORMS_CNT = 4;
 
-    gm_vector<unsigned char, 3> getColor() const { return color; }
-    gm_vector<double, 2> getPosition() const { return position; }
-    gm_vector<double, 2> getSpeedVector() const { return speedVector; }
-    int getMass() const { return mass; }
+// Adaptive mode splits step() into equal fixed sub-steps. Within one the fastest molecule moves at
+// most ADAPTIVE_STEP_CFL of the smallest collide radius, so no pair can pass through each other,
+// and at most ADAPTIVE_STEP_FREE_PATH_SHARE of the mean free path at the current density.
+static const double ADAPTIVE_STEP_CFL = 0.5;
+static const double ADAPTIVE_STEP_FREE_PATH_SHARE = 0.5;
+static const size_t ADAPTIVE_STEP_MAX_SUBSTEPS_CNT = 32;
 
-    void setPosition(const gm_vector<double, 2> &newPosition) {
-        position = newPosition;
-    }
+static const double PISTON_MAX_SPEED = 5;
+static const double PISTON_MIN_CORE_WIDTH = 1;
 
-    void sePhysicalState(const MoleculePhysicalStates state) { moleculePhysicalState = state; }
+static const size_t POISSON_DISK_MAX_ATTEMPTS = 30;
+static const size_t POISSON_DISK_MAX_CELLS_PER_MOLECULE = 4;
+// static const double INITIAL_CIRCLIT_RADIUS = 1;
+// static const double INITIAL_QUADRIT_LENGTH = 1;
 
-    MoleculeTypes getMoleculeType() const { return moleculeType; }
-    MoleculePhysicalStates getPhysicalState() const { return moleculePhysicalState; }
 
-    void setspeedVector(const gm_vector<double, 2> &newspeedVector) {
-        speedVector = newspeedVector;
-    }
+// what the last ADAPTIVE_STEP_MODE step() based its sub-steps on
+struct AdaptiveStepStats {
+    size_t substepsCnt = 0;
+    double substepSecs = 0;
 
-    
+    double maxSpeed = 0;
+    double minCollideRadius = 0;
+    double density = 0; // molecules per core coordinate unit^2
 
+    double cflStepSecs = 0;      // infinity when nothing moves
+    double freePathStepSecs = 0; // infinity when nothing moves or the box is empty
+    bool isSubstepsCapped = false; // the bounds asked for more than ADAPTIVE_STEP_MAX_SUBSTEPS_CNT
 };
 
-class Circlit : public Molecule {
-    double radius;
-
-public:    
-    Circlit
-    (
-        const gm_vector<double, 2> &position, 
-        const gm_vector<double, 2> &speedVector, 
-        const int mass, 
-        gm_vector<unsigned char, 3> color=CIRCLIT_COLOR
-    ): 
-        Molecule(position, speedVector, mass, color)
-    { 
-        moleculeType = MoleculeTypes::CIRCLIT;
-        radius = getRadius(); 
-    }
-
-    ~Circlit() override {}
 
+// Headless simulation: the core knows only its own coordinate system and is advanced
+// by explicit step() calls. Timers, widgets and canvas mapping live in ReactorCoreAdapter.
+class ReactorCore {
+    friend class ReactorCoreBench;
 
-    ShapeType getShapeType() const override { return ShapeType::CIRCLE; }
-    double getSize() const override { return radius; }
-    double getCollideCircleRadius() const override { return radius; }
-
-private:
-    double getRadius() const { return mass; }; // temp formula: radius = mass
-
-};
-
-class Quadrit : public Molecule {
-    double length;
-public:
-    Quadrit
-    (
-        const gm_vector<double, 2> &position, 
-        const gm_vector<double, 2> &speedVector, 
-        const int mass,  
-        gm_vector<unsigned char, 3> color=QUADRIT_COLOR
-    ): 
-        Molecule(position, speedVector, mass, color)
-    { 
-        moleculeType = MoleculeTypes::QUADRIT;
-        length = getLength(); 
-    }
-
-    ~Quadrit() override {}
+    PhiloxRandom randomGenerator;
+    uint64_t randomDrawsCnt;
+    uint64_t spawnedMoleculesCnt;
 
+    double cordSysWidth;
+    double cordSysHeight;
 
-    ShapeType getShapeType() const override { return ShapeType::SQUARE; }
-    double getSize() const override { return length; }
-    double getCollideCircleRadius() const override { return length / SQRT_2; }
+    // The piston is the left wall of the core. It travels towards its target at no more than
+    // PISTON_MAX_SPEED, molecules bounce off it in its own frame and so gain or lose energy.
+    double pistonPosition;
+    double pistonTargetPosition;
+    double pistonSpeed;
 
-private:
-    double getLength() const { return mass; }; // temp formula: length = mass
-};
 
-class ReactorCore : public QObject {
-    Q_OBJECT
 
-    
-    std::mt19937 randomGenerator;
 
-    gm_vector<double, 2> coreCanvasPos;
-    gm_vector<double, 2> coreCanvasSize;
-    double               coreCordSystemScale;
+    double currentReactorCoreTime;
+    double closestEventTimePoint;
+    MoleculeStore moleculeStore;
+    CoreObservables observables;
 
-    double cordSysWidth;
-    double cordSysHeight;
+    CollisionDetectionMode collisionDetectionMode;
+    UniformSpatialGrid spatialGrid;
+    SweepAndPrune sweepAndPrune;
+    DynamicAabbTree aabbTree;
 
-    int circlitCnt;
-    int quadritCnt;
+    // per tick buffer, kept as a member to reuse its capacity
+    std::vector<std::pair<size_t, size_t>> tickCandidatePairs;
 
+    // parallel stepping: absent when the core runs on the calling thread only
+    std::unique_ptr<WorkerPool> workerPool;
+    std::vector<std::vector<std::pair<size_t, size_t>>> partitionContactPairs;
+    std::vector<BoxWallImpulses> chunkWallImpulses;
 
+    gm_line<double, 2> walls[WALLS_CNT] = {};
 
+    SteppingMode steppingMode;
+    AdaptiveStepStats adaptiveStepStats;
 
-    double currentReactorCoreTime;
-    double closestEventTimePoint;
-    std::list<std::unique_ptr<Molecule>> moleculesList;
+    double deadCompactionShare;
 
-    enum WallType {
-        NONE_WALL = -1,
+    // Event-driven mode: predicted wall and molecule hits ordered by time point. An event is stale
+    // once any of its molecules changed its speed after the prediction, which eventsCnt tracks.
+    struct CoreEvent {
+        double timePoint;
+        size_t fstMoleculeIndex;
+        size_t sndMoleculeIndex; // NONE_MOLECULE_INDEX for wall hits
+        WallType wallType;
+        unsigned fstEventsCnt;
+        unsigned sndEventsCnt;
 
-        UPPER_WALL = 0,
-        LEFT_WALL = 1,
-        LOWER_WALL = 2,
-        RIGHT_WALL = 3,        
+        bool operator>(const CoreEvent &other) const {
+            return std::tie(timePoint, fstMoleculeIndex, sndMoleculeIndex) >
+                   std::tie(other.timePoint, other.fstMoleculeIndex, other.sndMoleculeIndex);
+        }
     };
 
-    static const size_t WALLS_CNT = 4;
-    gm_line<double, 2> walls[WALLS_CNT] = {};
+    std::vector<CoreEvent> coreEventsHeap;
+    std::vector<double> moleculeTimePoints;
+    std::vector<unsigned> moleculeEventsCnts;
+    std::vector<size_t> moleculeNeighbourStarts;
+    std::vector<size_t> moleculeNeighbours;
+
+    // not owned, published after every step when set
+    RenderSnapshotBuffer *renderSnapshotBuffer;
+    // not owned, offered every step when set
+    TrajectoryRecorder *trajectoryRecorder;
+    // not owned, pushed to after every step when set
+    CoreMetricsRing *coreMetricsRing;
 
 public:
     explicit ReactorCore
     (
-        const QRect &coreRectangle, const double coreCordSystemScale,
-        QObject *parent = nullptr
+        const double cordSysWidth, const double cordSysHeight,
+        const uint64_t seed = std::random_device{}()
     ) :
-        QObject(parent), randomGenerator(std::random_device{}()),
-        coreCordSystemScale(coreCordSystemScale)
+        randomGenerator(seed), randomDrawsCnt(0), spawnedMoleculesCnt(0),
+        pistonPosition(0), pistonTargetPosition(0), pistonSpeed(0),
+        collisionDetectionMode(UNIFORM_GRID_DETECTION),
+        steppingMode(FIXED_STEP_MODE),
+        deadCompactionShare(0),
+        renderSnapshotBuffer(nullptr),
+        trajectoryRecorder(nullptr),
+        coreMetricsRing(nullptr)
     {
-        auto *timer = new QTimer(this);
-        connect(timer, &QTimer::timeout, this, &ReactorCore::reactorCoreUpdateHandle);
-        timer->start(REACTOR_CORE_UPDATE_SECS);
-
-        setCoreRectangle(coreRectangle);
+        setCoreSize(cordSysWidth, cordSysHeight);
 
-        circlitCnt = 0;
-        quadritCnt = 0;
         currentReactorCoreTime = 0;
         closestEventTimePoint = std::numeric_limits<double>::quiet_NaN();
 
@@ -281,82 +210,178 @@ public:
         reactorCoreAddMolecule(/*moleculeType=*/QUADRIT);
     }
 
-    void setCoreRectangle(const QRect &coreRectangle) {
-        coreCanvasPos = gm_vector<double, 2>(coreRectangle.topLeft().x(), coreRectangle.topLeft().y());
-        coreCanvasSize = gm_vector<double, 2>(coreRectangle.width(), coreRectangle.height());
+    // Spawns moleculesCnt molecules in one batch with the same initial states one by one addCirclit/addQuadrit
+    // calls would give. POISSON_DISK_SPAWN keeps them out of contact with each other and with present
+    // molecules; molecules that find no free place are dropped. Returns the number of spawned molecules.
+    size_t addMolecules(const MoleculeTypes moleculeType, const size_t moleculesCnt, const SpawnDistribution distribution);
+
+    // Storage is never handed back: compaction keeps capacity, and reaction products and
+    // new molecules reuse it. Reserving the expected peak count up front makes every step,
+    // bursts included, free of heap allocations.
+    void reserveMolecules(const size_t moleculesCnt) {
+        moleculeStore.reserve(moleculesCnt);
+        chunkWallImpulses.reserve((moleculesCnt + BOX_IMPULSE_CHUNK_MOLECULES_CNT - 1) / BOX_IMPULSE_CHUNK_MOLECULES_CNT);
+        spatialGrid.reserve(moleculesCnt);
+        sweepAndPrune.reserve(moleculesCnt);
+        aabbTree.reserve(moleculesCnt);
+
+        moleculeTimePoints.reserve(moleculesCnt);
+        moleculeEventsCnts.reserve(moleculesCnt);
+        moleculeNeighbourStarts.reserve(moleculesCnt + 1);
+    }
+
+    MoleculeHandle addMolecule
+    (
+        const MoleculeTypes moleculeType,
+        const gm_vector<double, 2> &position,
+        const gm_vector<double, 2> &speedVector,
+        const int mass=INITIAL_MASS
+    ) {
+        MoleculeHandle handle = moleculeStore.addMolecule(moleculeType, position, speedVector, mass);
+        observables.addMolecule(moleculeStore, moleculeStore.getIndex(handle));
 
+        return handle;
+    }
 
-        cordSysWidth = coreCanvasSize.get_x() / coreCordSystemScale;
-        cordSysHeight = coreCanvasSize.get_y() / coreCordSystemScale;
+    void setCoreSize(const double newCordSysWidth, const double newCordSysHeight) {
+        cordSysWidth = newCordSysWidth;
+        cordSysHeight = newCordSysHeight;
         
         walls[UPPER_WALL] = gm_line<double, 2>({0, 0}, {1, 0});
-        walls[LEFT_WALL]  = gm_line<double, 2>({0, 0}, {0, 1});
         walls[LOWER_WALL] = gm_line<double, 2>({0, cordSysHeight}, {1, 0});
         walls[RIGHT_WALL] = gm_line<double, 2>({cordSysWidth,  0}, {0, 1});
+
+        pistonTargetPosition = std::min(pistonTargetPosition, getPistonMaxPosition());
+        setPistonWall(std::min(pistonPosition, getPistonMaxPosition()));
     }
-    
-    gm_vector<int, 2> convertMoleculeCords(const gm_vector<double, 2> &moleculeCords) const {
-        return moleculeCords * coreCordSystemScale + coreCanvasPos;
+
+    double getCordSysWidth() const { return cordSysWidth; }
+    double getCordSysHeight() const { return cordSysHeight; }
+
+    // the piston reaches the target over the next steps, moving no faster than PISTON_MAX_SPEED
+    void setPistonTarget(const double targetPosition) {
+        pistonTargetPosition = std::clamp(targetPosition, 0.0, getPistonMaxPosition());
     }
 
+    double getPistonPosition() const { return pistonPosition; }
+    double getPistonTarget() const { return pistonTargetPosition; }
+    double getPistonSpeed() const { return pistonSpeed; }
+
+    // uniform in [start, end)
     double randRange(double start, double end) {
-        return start + (end - start) * randomGenerator() / double(randomGenerator.max());
+        double uniform = 0;
+        randomGenerator.generateUniforms(REACTOR_CORE_RANDOM_STREAM, randomDrawsCnt++, &uniform, 1);
+        return start + (end - start) * uniform;
+    }
+
+    // Restarts every random stream: with the same seed, the same sequence of spawns and steps
+    // gives bit-identical trajectories on the serial path.
+    void setSeed(const uint64_t seed) {
+        randomGenerator.setSeed(seed);
+        randomDrawsCnt = 0;
+        spawnedMoleculesCnt = 0;
+    }
+    uint64_t getSeed() const { return randomGenerator.getSeed(); }
+
+    const MoleculeStore &getMoleculeStore() const { return moleculeStore; }
+    const CoreObservables &getObservables() const { return observables; }
+
+    // Versioned binary checkpoint of the whole simulation state: molecules, random streams, core
+    // time, geometry and modes. Saving writes sequentially, so any std::ostream works; loading maps
+    // the file and copies every store array in one go. The copied handles, types and states are
+    // checked before they replace anything: a failed load leaves the core untouched.
+    bool saveSnapshot(std::ostream &stream) const;
+    bool saveSnapshot(const std::string &path) const;
+    bool loadSnapshot(const void *data, const size_t size);
+    bool loadSnapshot(const std::string &path);
+
+    void setCollisionDetectionMode(const CollisionDetectionMode mode) { collisionDetectionMode = mode; }
+    CollisionDetectionMode getCollisionDetectionMode() const { return collisionDetectionMode; }
+
+    void setSteppingMode(const SteppingMode mode) { steppingMode = mode; }
+    SteppingMode getSteppingMode() const { return steppingMode; }
+    const AdaptiveStepStats &getAdaptiveStepStats() const { return adaptiveStepStats; }
+
+    // Molecules killed in reactions are dropped from the store at the end of a step only once they
+    // make up more than deadShare of it; until then they stay frozen and invisible to snapshots and
+    // recordings. 0, the default, compacts after every step with a death.
+    void setDeadCompactionShare(const double deadShare) { deadCompactionShare = std::clamp(deadShare, 0.0, 1.0); }
+    double getDeadCompactionShare() const { return deadCompactionShare; }
+
+    // Fixed steps with UNIFORM_GRID_DETECTION spread movement and contact search over threadsCnt
+    // threads. Reactions are still applied serially in index order and wall impulses are summed in
+    // a fixed chunk order, so results, observables included, match one thread bit for bit.
+    void setThreadsCnt(const size_t threadsCnt) {
+        if (threadsCnt == getThreadsCnt()) return;
+        workerPool = (threadsCnt > 1) ? std::make_unique<WorkerPool>(threadsCnt) : nullptr;
     }
+    size_t getThreadsCnt() const { return workerPool ? workerPool->getThreadsCnt() : 1; }
+
+    // The core is the only producer of the buffer: it must be stepped from a single thread,
+    // while another thread renders the snapshots it publishes.
+    void setRenderSnapshotBuffer(RenderSnapshotBuffer *buffer) { renderSnapshotBuffer = buffer; }
+    void fillRenderSnapshot(RenderSnapshot &snapshot) const;
+
+    // nullptr stops recording; the recorder must outlive its attachment
+    void setTrajectoryRecorder(TrajectoryRecorder *recorder) { trajectoryRecorder = recorder; }
+
+    // One sample per step goes to the ring; when the consumer falls behind and the ring is full,
+    // samples are dropped rather than stalling the step.
+    void setCoreMetricsRing(CoreMetricsRing *ring) { coreMetricsRing = ring; }
+    void fillCoreMetricsSample(CoreMetricsSample &sample) const;
 
-    const std::list<std::unique_ptr<Molecule>> &getMoleculeList() const { return moleculesList; }
+    double getCurrentTime() const { return currentReactorCoreTime; }
+    double getClosestEventTimePoint() const { return closestEventTimePoint; }
 
 
 private:
-    gm_vector<double, 2> genRandomVec(const double xMin, const double xMax, const double yMin, const double yMax) {
-        return gm_vector<double, 2> (randRange(xMin, xMax), randRange(yMin, yMax));
+    void genMoleculeInitUniforms(const size_t moleculesCnt, double *uniforms) const;
+    size_t placeMoleculesPoissonDisk(const MoleculeTypes moleculeType, const size_t moleculesCnt, const double *uniforms, double *xs, double *ys) const;
+
+    void reactorCoreAddMolecule(const enum MoleculeTypes moleculeType) {
+        addMolecules(moleculeType, 1, UNIFORM_SPAWN);
     }
 
-    gm_vector<double, 2> genRandomSpeedVec(const double minSpeed, const double maxSpeed) {
-        double randomAngle = randRange(0, 2 * std::numbers::pi);
-        gm_vector<double, 2> initSpeedVector = gm_vector<double, 2>(0, 1) * randRange(minSpeed, maxSpeed);
-        return initSpeedVector.rotate(randomAngle);
+    double getPistonMaxPosition() const { return std::max(0.0, cordSysWidth - PISTON_MIN_CORE_WIDTH); }
+
+    void setPistonWall(const double newPistonPosition) {
+        pistonPosition = newPistonPosition;
+        walls[LEFT_WALL] = gm_line<double, 2>({pistonPosition, 0}, {0, 1});
     }
 
-    void reactorCoreAddMolecule(const enum MoleculeTypes moleculeType) {
-        gm_vector<double, 2> moleculePosition = genRandomVec(0, cordSysWidth, 0, cordSysHeight);
-        gm_vector<double, 2> moleculetspeedVector = genRandomSpeedVec(MoleculeMinInitSpeed, MoleculeMaxInitSpeed);
+    void advancePiston(const double deltaSecs) {
+        double maxShift = PISTON_MAX_SPEED * deltaSecs;
+        double shift = std::clamp(pistonTargetPosition - pistonPosition, -maxShift, maxShift);
 
-        switch (moleculeType) {
-            case CIRCLIT:
-                moleculesList.push_back(std::make_unique<Circlit>(moleculePosition, moleculetspeedVector, INITIAL_MASS));
-                break;
-            case QUADRIT:
-                moleculesList.push_back(std::make_unique<Quadrit>(moleculePosition, moleculetspeedVector, INITIAL_MASS));
-                break;
-            default:
-                assert(0 && "switch(moleculeType) default");
-        }   
+        pistonSpeed = (deltaSecs > 0) ? shift / deltaSecs : 0;
+        setPistonWall(pistonPosition + shift);
     }
 
-    void updateMoleculePosition(std::list<std::unique_ptr<Molecule>>::iterator moleculeIT, const double deltaSecs) {
-        Molecule *moleculePtr = (*moleculeIT).get();
-        
+    bool isCoreBoxEmpty() const { return !(cordSysWidth > pistonPosition && cordSysHeight > 0); }
+
+    void updateMoleculePosition(const size_t moleculeIndex, const double deltaSecs) {
         gm_vector<double, 2> newPosition = 
-            moleculePtr->getPosition() + 
-            moleculePtr->getSpeedVector() * deltaSecs;
+            moleculeStore.getPosition(moleculeIndex) + 
+            moleculeStore.getSpeedVector(moleculeIndex) * deltaSecs;
         
-        moleculePtr->setPosition(newPosition);
+        moleculeStore.setPosition(moleculeIndex, newPosition);
     }
 
 
-    double getWallIntersectionDelta(std::list<std::unique_ptr<Molecule>>::iterator moleculeIT, WallType wallType) {
-        Molecule *moleculePtr = (*moleculeIT).get();
+    double getWallIntersectionDelta(const size_t moleculeIndex, WallType wallType) {
+        gm_vector<double, 2> moleculePosition = moleculeStore.getPosition(moleculeIndex);
+        gm_vector<double, 2> moleculeSpeedVector = moleculeStore.getSpeedVector(moleculeIndex);
 
-        gm_line<double, 2> moveRay(moleculePtr->getPosition(), moleculePtr->getSpeedVector());
+        gm_line<double, 2> moveRay(moleculePosition, moleculeSpeedVector);
         gm_vector<double, 2> intersection = get_ray_line_intersection(moveRay, walls[wallType]);
         
         if (intersection.is_poison()) return std::numeric_limits<double>::quiet_NaN();
-        if (intersection.get_x() < 0 || intersection.get_x() > cordSysWidth) return std::numeric_limits<double>::quiet_NaN();
+        if (intersection.get_x() < pistonPosition || intersection.get_x() > cordSysWidth) return std::numeric_limits<double>::quiet_NaN();
         if (intersection.get_y() < 0 || intersection.get_y() > cordSysHeight) return std::numeric_limits<double>::quiet_NaN();
 
-        gm_vector<double, 2> path = intersection - moleculePtr->getPosition();
+        gm_vector<double, 2> path = intersection - moleculePosition;
 
-        double curDelta = path.get_len2() / moleculePtr->getSpeedVector().get_len2();
+        double curDelta = path.get_len2() / moleculeSpeedVector.get_len2();
 
         return std::sqrt(curDelta);
     } 
@@ -369,53 +394,44 @@ private:
             case UPPER_WALL:
                 return gm_vector<double, 2>({x, -y});
             case LEFT_WALL:
-                return gm_vector<double, 2>({-x, y});
+                // reflection in the piston frame, like integrateBoxMovement folds it
+                return gm_vector<double, 2>({isApproachingPiston(x) ? 2 * pistonSpeed - x : x, y});
             case LOWER_WALL:
                 return gm_vector<double, 2>({x, -y});
             case RIGHT_WALL:
                 return gm_vector<double, 2>({-x, y});
             default:
                 assert(0 && "unknown wallType");
+                return speedVector;
         }
     }
 
-    void ProcessMoleculeMovement(std::list<std::unique_ptr<Molecule>>::iterator moleculeIT, double deltaSecs) {
-        Molecule *moleculePtr = (*moleculeIT).get();
-
-        if (moleculePtr->getPhysicalState() == DEATH) return; 
-
-        for (size_t i = 0; i < WALLS_CNT; i++) {
-            WallType wallType = WallType (i);
-
-            double intersectionDelta = getWallIntersectionDelta(moleculeIT, wallType);
+    // The piston stays at its end of step position during an event-driven step. A molecule reaches
+    // it only moving left, and catches it only being faster than it: one slower than a receding
+    // piston stays in front of the position the piston has already moved to.
+    bool isApproachingPiston(const double speedX) const { return speedX < std::min(pistonSpeed, 0.0); }
 
-            if (std::isnan(intersectionDelta) || intersectionDelta > deltaSecs) continue;
+    bool isMovingTowardsWall(const size_t moleculeIndex, const WallType wallType) const {
+        gm_vector<double, 2> speedVector = moleculeStore.getSpeedVector(moleculeIndex);
 
-            gm_vector<double, 2> moveVector = 
-                moleculePtr->getSpeedVector() * intersectionDelta + 
-                processWallCollision(moleculePtr->getSpeedVector() * (deltaSecs - intersectionDelta), wallType);
-    
-            moleculePtr->setPosition(moleculePtr->getPosition() + moveVector);
-            moleculePtr->setspeedVector(processWallCollision(moleculePtr->getSpeedVector(), wallType));
-            return;
+        switch (wallType) {
+            case UPPER_WALL: return speedVector.get_y() < 0;
+            case LEFT_WALL:  return isApproachingPiston(speedVector.get_x());
+            case LOWER_WALL: return speedVector.get_y() > 0;
+            case RIGHT_WALL: return speedVector.get_x() > 0;
+            default:
+                assert(0 && "unknown wallType");
+                return false;
         }
-
-        updateMoleculePosition(moleculeIT, deltaSecs);
     }
 
-    double getMoleculeCollisionDelta(
-        std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-        std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT
-    ) {
-        Molecule *fstMoleculePTR = (*fstMoleculeIT).get();
-        Molecule *sndMoleculePTR = (*sndMoleculeIT).get();
-
-        double coliisionRadius = fstMoleculePTR->getCollideCircleRadius() + sndMoleculePTR->getCollideCircleRadius();
+    double getMoleculeCollisionDelta(const size_t fstMoleculeIndex, const size_t sndMoleculeIndex) {
+        double coliisionRadius = moleculeStore.getCollideCircleRadius(fstMoleculeIndex) + moleculeStore.getCollideCircleRadius(sndMoleculeIndex);
         double coliisionRadius2 = coliisionRadius * coliisionRadius;
 
     
-        gm_vector<double, 2> V = fstMoleculePTR->getSpeedVector() - sndMoleculePTR->getSpeedVector();
-        gm_vector<double, 2> P = fstMoleculePTR->getPosition() - sndMoleculePTR->getPosition();
+        gm_vector<double, 2> V = moleculeStore.getSpeedVector(fstMoleculeIndex) - moleculeStore.getSpeedVector(sndMoleculeIndex);
+        gm_vector<double, 2> P = moleculeStore.getPosition(fstMoleculeIndex) - moleculeStore.getPosition(sndMoleculeIndex);
         
     
         double t1 = 0, t2 = 0;
@@ -432,60 +448,155 @@ private:
         return t1;
     }
 
-    void processMoleculeCollision
-    (
-        std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-        std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT 
-    ) {
-     
+    // Time of impact of the exact shapes, NaN when they do not meet. Seen from the snd molecule the
+    // fst one is a point moving along P + V t, and it touches snd when it enters the Minkowski sum of
+    // both shapes: a square of half side h1 + h2 rounded by r1 + r2.
+    double getMoleculeShapesCollisionDelta(const size_t fstMoleculeIndex, const size_t sndMoleculeIndex) const {
+        gm_vector<double, 2> V = moleculeStore.getSpeedVector(fstMoleculeIndex) - moleculeStore.getSpeedVector(sndMoleculeIndex);
+        gm_vector<double, 2> P = moleculeStore.getPosition(fstMoleculeIndex) - moleculeStore.getPosition(sndMoleculeIndex);
+
+        double boxHalfSide = moleculeStore.getBoxHalfSide(fstMoleculeIndex) + moleculeStore.getBoxHalfSide(sndMoleculeIndex);
+        double roundRadius = moleculeStore.getRoundRadius(fstMoleculeIndex) + moleculeStore.getRoundRadius(sndMoleculeIndex);
+        double grownHalfSide = boxHalfSide + roundRadius;
+
+        // entry into the square grown by the round radius, slab by slab
+        double enterDelta = 0;
+        double exitDelta = std::numeric_limits<double>::infinity();
+        for (auto [cord, speed] : {std::pair(P.get_x(), V.get_x()), std::pair(P.get_y(), V.get_y())}) {
+            if (speed == 0) {
+                if (std::abs(cord) > grownHalfSide) return std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+
+            double nearDelta = (-grownHalfSide - cord) / speed;
+            double farDelta = (grownHalfSide - cord) / speed;
+            enterDelta = std::max(enterDelta, std::min(nearDelta, farDelta));
+            exitDelta = std::min(exitDelta, std::max(nearDelta, farDelta));
+        }
 
-        Molecule *fstMoleculePTR = (*fstMoleculeIT).get();
-        Molecule *sndMoleculePTR = (*sndMoleculeIT).get();
+        if (enterDelta > exitDelta) return std::numeric_limits<double>::quiet_NaN();
 
-        if (fstMoleculePTR->getPhysicalState() != ALIVE || sndMoleculePTR->getPhysicalState() != ALIVE) return; 
+        // next to a side the grown square is exact, in a corner region the corner is a circle
+        gm_vector<double, 2> enterPoint = P + V * enterDelta;
+        if (std::abs(enterPoint.get_x()) <= boxHalfSide || std::abs(enterPoint.get_y()) <= boxHalfSide) return enterDelta;
 
-        double distance2 = (fstMoleculePTR->getPosition() - sndMoleculePTR->getPosition()).get_len2();
-        double collisionDistance = (fstMoleculePTR->getCollideCircleRadius() + sndMoleculePTR->getCollideCircleRadius());
+        gm_vector<double, 2> corner(std::copysign(boxHalfSide, enterPoint.get_x()), std::copysign(boxHalfSide, enterPoint.get_y()));
+        gm_vector<double, 2> C = P - corner;
 
-        if (distance2 - collisionDistance * collisionDistance < DISTANCE_COLLISION_EPS2)
-            launchMoleculeReaction(moleculesList, fstMoleculeIT, sndMoleculeIT);
+        double t1 = 0, t2 = 0;
+        int nRoots = 0;
+        solveQuadratic(V.get_len2(), 2 * (C.get_x() * V.get_x() + C.get_y() * V.get_y()), C.get_len2() - roundRadius * roundRadius, &t1, &t2, &nRoots);
+
+        if (nRoots != 2 || t1 < 0 || t1 > exitDelta) return std::numeric_limits<double>::quiet_NaN();
+        return t1;
     }
 
-signals:
-    void reactorCoreUpdated();
+    bool isCollideCircleExact(const size_t moleculeIndex) const {
+        return moleculeStore.getShapeType(moleculeIndex) == ShapeType::CIRCLE;
+    }
 
-public slots:
-    void reactorCoreUpdate(const double deltaSecs) {
-        for (auto fstMoleculeIT = moleculesList.begin(); fstMoleculeIT != moleculesList.end() && 
-                                                         (*fstMoleculeIT).get()->getPhysicalState() != UNRESPONSIVE; fstMoleculeIT++) {
-            ProcessMoleculeMovement(fstMoleculeIT, deltaSecs);
-        
-            for (auto sndMoleculeIT = std::next(fstMoleculeIT); sndMoleculeIT != moleculesList.end(); sndMoleculeIT++) {
-                processMoleculeCollision(fstMoleculeIT, sndMoleculeIT);
-            }
-        }
+    // Two stages: the bounding circles reject most candidates with one distance check, only
+    // pairs they accept are tested against the exact shapes.
+    bool isMoleculesInContact(const size_t fstMoleculeIndex, const size_t sndMoleculeIndex) const {
+        gm_vector<double, 2> offset = moleculeStore.getPosition(fstMoleculeIndex) - moleculeStore.getPosition(sndMoleculeIndex);
+        double distance2 = offset.get_len2();
+        double collisionDistance = (moleculeStore.getCollideCircleRadius(fstMoleculeIndex) + moleculeStore.getCollideCircleRadius(sndMoleculeIndex));
 
-        
-        std::list<std::unique_ptr<Molecule>>::iterator curMoleculeIT = moleculesList.begin();
-        while (curMoleculeIT != moleculesList.end()) {
-            auto nextMoleculeIT = std::next(curMoleculeIT);
-            Molecule *curMoleculePTR = (*curMoleculeIT).get(); 
-            
-            switch(curMoleculePTR->getPhysicalState()) {
-                case DEATH: moleculesList.erase(curMoleculeIT); break;
-                case UNRESPONSIVE: curMoleculePTR->sePhysicalState(ALIVE); break;
-                case ALIVE: break;
-                default: assert(0);
-            }
-            curMoleculeIT = nextMoleculeIT;
+        if (!(distance2 - collisionDistance * collisionDistance < DISTANCE_COLLISION_EPS2)) return false;
+
+        // Minkowski sum of the shapes, see getMoleculeShapesCollisionDelta; for two circles it is
+        // implied by the bounding circle test
+        double boxHalfSide = moleculeStore.getBoxHalfSide(fstMoleculeIndex) + moleculeStore.getBoxHalfSide(sndMoleculeIndex);
+        double roundRadius = moleculeStore.getRoundRadius(fstMoleculeIndex) + moleculeStore.getRoundRadius(sndMoleculeIndex);
+
+        double outsideX = std::max(std::abs(offset.get_x()) - boxHalfSide, 0.0);
+        double outsideY = std::max(std::abs(offset.get_y()) - boxHalfSide, 0.0);
+        double contactDistance = roundRadius + DISTANCE_COLLISION_EPS;
+
+        return outsideX * outsideX + outsideY * outsideY < contactDistance * contactDistance;
+    }
+
+    // every reaction goes through here, so observables see reactants die and products appear
+    void reactMolecules(const size_t fstMoleculeIndex, const size_t sndMoleculeIndex) {
+        size_t prevMoleculesCnt = moleculeStore.size();
+        launchMoleculeReaction(moleculeStore, fstMoleculeIndex, sndMoleculeIndex);
+
+        for (size_t moleculeIndex : {fstMoleculeIndex, sndMoleculeIndex}) {
+            if (moleculeStore.getPhysicalState(moleculeIndex) != DEATH) continue;
+
+            observables.removeMolecule(moleculeStore, moleculeIndex);
+            moleculeStore.freezeDeadMolecule(moleculeIndex);
         }
+        observables.addMolecules(moleculeStore, prevMoleculesCnt, moleculeStore.size());
+    }
 
-        emit reactorCoreUpdated();
+    void processMoleculeCollision(const size_t fstMoleculeIndex, const size_t sndMoleculeIndex) {
+        if (moleculeStore.getPhysicalState(fstMoleculeIndex) != ALIVE || moleculeStore.getPhysicalState(sndMoleculeIndex) != ALIVE) return; 
+
+        if (isMoleculesInContact(fstMoleculeIndex, sndMoleculeIndex))
+            reactMolecules(fstMoleculeIndex, sndMoleculeIndex);
     }
 
-private slots:
-    void reactorCoreUpdateHandle() {
-        reactorCoreUpdate(REACTOR_CORE_UPDATE_SECS);
+    // compaction walks the whole store, so the molecule aggregates are rebuilt along with it
+    void removeDeadMolecules() {
+        if (moleculeStore.removeDeadMolecules(deadCompactionShare))
+            observables.recountMolecules(moleculeStore);
+    }
+
+    void processCollisionsBruteForce();
+    void processCollisionsUniformGrid();
+    void processCollisionsUniformGridParallel();
+    void processCollisionsSweepAndPrune();
+    void processCollisionsAabbTree(const double deltaSecs);
+
+    void sweepMoleculesBehindPiston();
+    void fixedStepUpdate(const double deltaSecs);
+    void eventDrivenUpdate(const double deltaSecs);
+    void adaptiveStepUpdate(const double deltaSecs);
+    void updateAdaptiveStepStats(const double deltaSecs);
+
+    void buildEventNeighbours(const double deltaSecs);
+    void driftMolecule(const size_t moleculeIndex, const double timePoint);
+    void predictWallEvent(const size_t moleculeIndex);
+    void predictMoleculeEvents(const size_t moleculeIndex, const double endTimePoint, const bool onlyLaterNeighbours);
+    void pushCoreEvent(const CoreEvent &event);
+    bool isCoreEventValid(const CoreEvent &event) const;
+
+public:
+    void step(const double deltaSecs) {
+        switch (steppingMode) {
+            case FIXED_STEP_MODE:
+                advancePiston(deltaSecs);
+                fixedStepUpdate(deltaSecs);
+                break;
+            case EVENT_DRIVEN_MODE:
+                advancePiston(deltaSecs);
+                eventDrivenUpdate(deltaSecs);
+                break;
+            case ADAPTIVE_STEP_MODE:
+                // the piston advances once per sub-step
+                adaptiveStepUpdate(deltaSecs);
+                break;
+            default: assert(0 && "unknown steppingMode");
+        }
+
+        removeDeadMolecules();
+        currentReactorCoreTime += deltaSecs;
+        observables.finishStep(deltaSecs, isCoreBoxEmpty() ? 0 : cordSysWidth - pistonPosition, cordSysHeight);
+
+        if (renderSnapshotBuffer) {
+            fillRenderSnapshot(renderSnapshotBuffer->getBackSlot());
+            renderSnapshotBuffer->publish();
+        }
+
+        if (trajectoryRecorder)
+            trajectoryRecorder->onTick(moleculeStore, currentReactorCoreTime);
+
+        if (coreMetricsRing) {
+            CoreMetricsSample sample;
+            fillCoreMetricsSample(sample);
+            coreMetricsRing->tryPush(sample);
+        }
     }
 };
 
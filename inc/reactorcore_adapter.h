@@ -0,0 +1,203 @@
+#ifndef REACTORCORE_ADAPTER_H
+#define REACTORCORE_ADAPTER_H
+
+#include <QObject>
+#include <QRect>
+#include <QTimer>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "reactorcore.h"
+#include "timestep_driver.h"
+
+static const int REACTOR_CANVAS_FRAME_MS = 16;
+
+// Qt front of the headless ReactorCore. The core is stepped on its own simulation thread and the
+// GUI thread never touches it: changes are posted as commands run between two steps, and widgets
+// draw the render snapshots the core publishes. The simulation thread paces fixed steps against
+// the wall clock through a TimestepDriver and sleeps while no step is owed. Also maps canvas
+// rectangles onto the core coordinate system and notifies widgets at frame rate when a new
+// snapshot is ready.
+class ReactorCoreAdapter : public QObject {
+    Q_OBJECT
+
+    typedef std::function<void (ReactorCore &reactorCore)> ReactorCoreCommand;
+
+    ReactorCore reactorCore;
+    RenderSnapshotBuffer renderSnapshots;
+    CoreMetricsRing coreMetrics;
+
+    std::mutex postedCommandsMutex;
+    std::condition_variable postedCommandsCondition;
+    std::vector<ReactorCoreCommand> postedCommands;
+
+    // simulation thread only
+    std::vector<ReactorCoreCommand> runningCommands;
+    TimestepDriver timestepDriver;
+    std::unique_ptr<TrajectoryRecorder> trajectoryRecorder;
+
+    std::atomic<bool> isSimulationRunning;
+    std::thread simulationThread;
+
+    gm_vector<double, 2> coreCanvasPos;
+    double               coreCordSystemScale;
+
+public:
+    explicit ReactorCoreAdapter
+    (
+        const QRect &coreRectangle, const double coreCordSystemScale,
+        QObject *parent = nullptr
+    ) :
+        QObject(parent),
+        reactorCore(coreRectangle.width() / coreCordSystemScale, coreRectangle.height() / coreCordSystemScale),
+        timestepDriver(REACTOR_CORE_UPDATE_SECS),
+        isSimulationRunning(true),
+        coreCordSystemScale(coreCordSystemScale)
+    {
+        reactorCore.setRenderSnapshotBuffer(&renderSnapshots);
+        reactorCore.setCoreMetricsRing(&coreMetrics);
+        setCoreRectangle(coreRectangle);
+
+        auto *frameTimer = new QTimer(this);
+        connect(frameTimer, &QTimer::timeout, this, &ReactorCoreAdapter::renderFrameHandle);
+        frameTimer->start(REACTOR_CANVAS_FRAME_MS);
+
+        simulationThread = std::thread(&ReactorCoreAdapter::simulationLoop, this);
+    }
+
+    ~ReactorCoreAdapter() {
+        {
+            std::lock_guard<std::mutex> lock(postedCommandsMutex);
+            isSimulationRunning.store(false, std::memory_order_relaxed);
+        }
+
+        postedCommandsCondition.notify_one();
+        simulationThread.join();
+    }
+
+    // latest snapshot published by the core, valid until the next call; GUI thread only
+    const RenderSnapshot &acquireRenderSnapshot() { return renderSnapshots.acquireFrontSlot(); }
+
+    // oldest metrics sample not taken yet, one per step; GUI thread only
+    bool popCoreMetricsSample(CoreMetricsSample &sample) { return coreMetrics.tryPop(sample); }
+
+    // simulated seconds per wall second, 0 pauses the simulation
+    void setTimeScale(const double timeScale) {
+        postTimestepDriverCommand([=](TimestepDriver &timestepDriver) { timestepDriver.setTimeScale(timeScale); });
+    }
+
+    // records every recordEveryTicks-th step to path, replacing any running recording
+    void startTrajectoryRecording(const std::string &path, const size_t recordEveryTicks) {
+        postReactorCoreCommand([=, this](ReactorCore &reactorCore) {
+            reactorCore.setTrajectoryRecorder(nullptr);
+            trajectoryRecorder = std::make_unique<TrajectoryRecorder>(path, recordEveryTicks);
+            reactorCore.setTrajectoryRecorder(trajectoryRecorder.get());
+        });
+    }
+
+    void stopTrajectoryRecording() {
+        postReactorCoreCommand([this](ReactorCore &reactorCore) {
+            reactorCore.setTrajectoryRecorder(nullptr);
+            trajectoryRecorder.reset();
+        });
+    }
+
+    void addCirclit() { postReactorCoreCommand([](ReactorCore &reactorCore) { reactorCore.addCirclit(); }); }
+    void addQuadrit() { postReactorCoreCommand([](ReactorCore &reactorCore) { reactorCore.addQuadrit(); }); }
+
+    // the core coordinate system spans the whole reactor, piston travel included
+    void setCoreRectangle(const QRect &coreRectangle) {
+        coreCanvasPos = gm_vector<double, 2>(coreRectangle.topLeft().x(), coreRectangle.topLeft().y());
+
+        double coreWidth = coreRectangle.width() / coreCordSystemScale;
+        double coreHeight = coreRectangle.height() / coreCordSystemScale;
+        postReactorCoreCommand([=](ReactorCore &reactorCore) { reactorCore.setCoreSize(coreWidth, coreHeight); });
+    }
+
+    void setPistonRectangle(const QRect &pistonRectangle) {
+        double pistonTarget = (pistonRectangle.left() + pistonRectangle.width() - coreCanvasPos.get_x()) / coreCordSystemScale;
+        postReactorCoreCommand([=](ReactorCore &reactorCore) { reactorCore.setPistonTarget(pistonTarget); });
+    }
+
+    const gm_vector<double, 2> &getCoreCanvasPos() const { return coreCanvasPos; }
+    double getCoreCordSystemScale() const { return coreCordSystemScale; }
+
+    gm_vector<int, 2> convertMoleculeCords(const gm_vector<double, 2> &moleculeCords) const {
+        return moleculeCords * coreCordSystemScale + coreCanvasPos;
+    }
+
+signals:
+    void reactorCoreUpdated();
+
+private:
+    void postReactorCoreCommand(ReactorCoreCommand &&command) {
+        {
+            std::lock_guard<std::mutex> lock(postedCommandsMutex);
+            postedCommands.push_back(std::move(command));
+        }
+
+        postedCommandsCondition.notify_one();
+    }
+
+    template <typename TimestepDriverHandle>
+    void postTimestepDriverCommand(TimestepDriverHandle &&timestepDriverHandle) {
+        postReactorCoreCommand([this, timestepDriverHandle](ReactorCore &) { timestepDriverHandle(timestepDriver); });
+    }
+
+    void runPostedCommands() {
+        {
+            std::lock_guard<std::mutex> lock(postedCommandsMutex);
+            runningCommands.swap(postedCommands);
+        }
+
+        for (ReactorCoreCommand &command : runningCommands)
+            command(reactorCore);
+        runningCommands.clear();
+    }
+
+    // sleeps up to waitSecs, waking early when a command is posted or the simulation stops
+    void waitPostedCommands(const double waitSecs) {
+        std::unique_lock<std::mutex> lock(postedCommandsMutex);
+        auto isAwaken = [this]() { return !postedCommands.empty() || !isSimulationRunning.load(std::memory_order_relaxed); };
+
+        if (std::isinf(waitSecs))
+            postedCommandsCondition.wait(lock, isAwaken);
+        else
+            postedCommandsCondition.wait_for(lock, std::chrono::duration<double>(waitSecs), isAwaken);
+    }
+
+    void simulationLoop() {
+        auto prevTimePoint = std::chrono::steady_clock::now();
+
+        while (isSimulationRunning.load(std::memory_order_relaxed)) {
+            // wall time is accounted before commands run, so a new time scale only applies from now on
+            auto timePoint = std::chrono::steady_clock::now();
+            size_t stepsCnt = timestepDriver.advance(std::chrono::duration<double>(timePoint - prevTimePoint).count());
+            prevTimePoint = timePoint;
+
+            runPostedCommands();
+
+            for (size_t stepIndex = 0; stepIndex < stepsCnt; stepIndex++)
+                reactorCore.step(timestepDriver.getFixedStepSecs());
+
+            waitPostedCommands(timestepDriver.getSecsToNextStep());
+        }
+    }
+
+private slots:
+    void renderFrameHandle() {
+        if (renderSnapshots.hasFreshSlot())
+            emit reactorCoreUpdated();
+    }
+};
+
+#endif // REACTORCORE_ADAPTER_H
@@ -1,26 +1,91 @@
-// #ifndef RECORD_WIDGET_H
-// #define RECORD_WIDGET_H
+#ifndef RECORD_WIDGET_H
+#define RECORD_WIDGET_H
 
-// #include <QWidget>
-// #include <QTimer>
+#include <QVector>
+#include <QWidget>
 
-// #include "qcustomplot.h"
+#include <cstddef>
+#include <vector>
 
+#include "qcustomplot.h"
+#include "reactorcore_adapter.h"
 
-// class RecorderWidget : public QWidget {
-//     Q_OBJECT
-// public:
-//     explicit RecorderWidget(QWidget *parent = nullptr);
+static const size_t RECORDER_HISTORY_CAPACITY = 1 << 16;
+static const double RECORDER_WINDOW_SECS = 10;
 
-// private slots:
-//     void updatePlot();
+enum RecorderSeries {
+    CIRCLITS_SERIES,
+    QUADRITS_SERIES,
+    KINETIC_ENERGY_SERIES,
+    PRESSURE_SERIES,
+};
 
-// private:
-//     QCustomPlot *plot;
-//     QTimer *timer;
-//     QVector<double> xData, yData;
-//     double t;          // simulation time
-//     int maxPoints;
-// };
+static const size_t RECORDER_SERIES_CNT = 4;
 
-// #endif // RECORD_WIDGET_H
+// The last capacity metrics samples, one column per series. Once full the oldest sample is
+// overwritten, so memory and every scan stay bounded however long the simulation runs.
+class RecorderHistory {
+    std::vector<double> timePoints;
+    std::vector<double> seriesValues[RECORDER_SERIES_CNT];
+    size_t oldestSlot;
+    size_t samplesCnt;
+
+public:
+    explicit RecorderHistory(const size_t capacity=RECORDER_HISTORY_CAPACITY);
+
+    // samples are expected in time order
+    void push(const CoreMetricsSample &sample);
+    void clear() { oldestSlot = samplesCnt = 0; }
+
+    size_t size() const { return samplesCnt; }
+
+    // sampleIndex counts from the oldest sample
+    double getTimePoint(const size_t sampleIndex) const { return timePoints[getSlot(sampleIndex)]; }
+    double getValue(const RecorderSeries series, const size_t sampleIndex) const {
+        return seriesValues[series][getSlot(sampleIndex)];
+    }
+
+    // index of the first sample not earlier than timePoint, size() when there is none
+    size_t findFirstSample(const double timePoint) const;
+
+private:
+    size_t getSlot(const size_t sampleIndex) const {
+        size_t slot = oldestSlot + sampleIndex;
+        return (slot < timePoints.size()) ? slot : slot - timePoints.size();
+    }
+};
+
+// Min/max decimation of the samples in [startTimePoint, endTimePoint] split into columnsCnt pixel
+// columns: every column keeps only its lowest and highest sample, in the order they occurred. Spikes
+// stay visible, and the plot gets at most two points per column whatever the sampling rate.
+void decimateRecorderSeries
+(
+    const RecorderHistory &history, const RecorderSeries series,
+    const double startTimePoint, const double endTimePoint, const int columnsCnt,
+    QVector<double> &keys, QVector<double> &values
+);
+
+// Live plots of molecule counts, kinetic energy and pressure over the last RECORDER_WINDOW_SECS of
+// simulated time. Takes every sample the core pushes, one per step, and replots at frame rate.
+class RecorderWidget : public QWidget {
+    Q_OBJECT
+
+    ReactorCoreAdapter *reactorCore;
+
+    QCustomPlot *plot;
+    QCPGraph *seriesGraphs[RECORDER_SERIES_CNT];
+
+    RecorderHistory history;
+
+    // kept between frames, so decimation stops allocating once warmed up
+    QVector<double> decimatedKeys;
+    QVector<double> decimatedValues;
+
+public:
+    explicit RecorderWidget(ReactorCoreAdapter *reactorCore, QWidget *parent = nullptr);
+
+private slots:
+    void updatePlot();
+};
+
+#endif // RECORD_WIDGET_H
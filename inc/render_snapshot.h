@@ -0,0 +1,40 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include "molecule.h"
+#include "triple_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Everything the canvas needs to draw one tick, in core coordinates. Filled by the core,
+// read by the GUI thread, so painting never touches the live MoleculeStore.
+struct RenderSnapshot {
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> sizes;
+    std::vector<ShapeType> shapeTypes;
+    std::vector<uint32_t> colors; // 0xRRGGBB
+
+    double pistonPosition = 0;
+    double timePoint = 0;
+
+    size_t size() const { return xs.size(); }
+
+    void resize(const size_t moleculesCnt) {
+        xs.resize(moleculesCnt);
+        ys.resize(moleculesCnt);
+        sizes.resize(moleculesCnt);
+        shapeTypes.resize(moleculesCnt);
+        colors.resize(moleculesCnt);
+    }
+};
+
+typedef TripleBuffer<RenderSnapshot> RenderSnapshotBuffer;
+
+inline uint32_t packRenderColor(const gm_vector<unsigned char, 3> &color) {
+    return (uint32_t(color.get_x()) << 16) | (uint32_t(color.get_y()) << 8) | uint32_t(color.get_z());
+}
+
+#endif // RENDER_SNAPSHOT_H
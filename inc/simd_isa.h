@@ -0,0 +1,35 @@
+#ifndef SIMD_ISA_H
+#define SIMD_ISA_H
+
+// Kernels with SIMD variants are compiled for every ISA below via target attributes
+// and pick one at runtime, so the build needs no -march flags.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_ISA_X86
+#endif
+
+enum SimdIsa {
+    SCALAR_SIMD_ISA,
+    AVX2_SIMD_ISA,
+    AVX512_SIMD_ISA,
+};
+
+inline bool isSimdIsaSupported(const SimdIsa isa) {
+    switch (isa) {
+        case SCALAR_SIMD_ISA: return true;
+#ifdef SIMD_ISA_X86
+        case AVX2_SIMD_ISA:   return __builtin_cpu_supports("avx2");
+        case AVX512_SIMD_ISA: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return false;
+    }
+}
+
+// widest ISA the running CPU supports, detected once
+inline SimdIsa getBestSimdIsa() {
+    static const SimdIsa bestIsa = isSimdIsaSupported(AVX512_SIMD_ISA) ? AVX512_SIMD_ISA :
+                                   isSimdIsaSupported(AVX2_SIMD_ISA)   ? AVX2_SIMD_ISA   :
+                                                                         SCALAR_SIMD_ISA;
+    return bestIsa;
+}
+
+#endif // SIMD_ISA_H
@@ -0,0 +1,84 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+static const size_t SPATIAL_GRID_MAX_CELLS_PER_ITEM = 4;
+static const size_t SPATIAL_GRID_MIN_CELLS = 64;
+
+// Uniform grid over [originX, originX + width] x [0, height]. Items are bucketed with a counting sort,
+// so a rebuild is two linear passes and cells are contiguous in memory.
+// Items outside the area are clamped into the border cells, which keeps neighbour queries exact.
+class UniformSpatialGrid {
+    double cellSize;
+    size_t cols;
+    size_t rows;
+
+    std::vector<size_t> itemCells;
+    std::vector<size_t> cellStarts;
+    std::vector<size_t> cellItems;
+
+public:
+    UniformSpatialGrid(): cellSize(1), cols(1), rows(1) {}
+
+    void reserve(const size_t itemsCnt) {
+        itemCells.reserve(itemsCnt);
+        cellItems.reserve(itemsCnt);
+        cellStarts.reserve(std::max(SPATIAL_GRID_MIN_CELLS, itemsCnt * SPATIAL_GRID_MAX_CELLS_PER_ITEM) + 1);
+    }
+
+    void rebuild
+    (
+        const double *xs, const double *ys, const size_t itemsCnt,
+        const double minCellSize, const double originX, const double width, const double height
+    );
+
+    // Calls pairHandle(i, j) once for every unordered pair of items lying in the same or
+    // in adjacent cells. Any two items closer than minCellSize are guaranteed to be reported.
+    template <typename PairHandle>
+    void forEachCandidatePair(PairHandle &&pairHandle) const {
+        forEachCandidatePairInCells(0, getCellsCnt(), pairHandle);
+    }
+
+    // Part of forEachCandidatePair owned by cells [cellBegin, cellEnd): disjoint cell ranges
+    // report disjoint pair sets, so ranges can be processed by different threads.
+    template <typename PairHandle>
+    void forEachCandidatePairInCells(const size_t cellBegin, const size_t cellEnd, PairHandle &&pairHandle) const {
+        static const int FORWARD_NEIGHBOURS_CNT = 4;
+        static const int forwardNeighbours[FORWARD_NEIGHBOURS_CNT][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+        for (size_t cell = cellBegin; cell < cellEnd; cell++) {
+            size_t row = cell / cols;
+            size_t col = cell % cols;
+
+            for (size_t fst = cellStarts[cell]; fst < cellStarts[cell + 1]; fst++) {
+                for (size_t snd = fst + 1; snd < cellStarts[cell + 1]; snd++)
+                    pairHandle(cellItems[fst], cellItems[snd]);
+            }
+
+            for (int i = 0; i < FORWARD_NEIGHBOURS_CNT; i++) {
+                long neighbourCol = long(col) + forwardNeighbours[i][0];
+                long neighbourRow = long(row) + forwardNeighbours[i][1];
+                if (neighbourCol < 0 || neighbourCol >= long(cols) || neighbourRow >= long(rows)) continue;
+
+                size_t neighbourCell = size_t(neighbourRow) * cols + size_t(neighbourCol);
+
+                for (size_t fst = cellStarts[cell]; fst < cellStarts[cell + 1]; fst++) {
+                    for (size_t snd = cellStarts[neighbourCell]; snd < cellStarts[neighbourCell + 1]; snd++)
+                        pairHandle(cellItems[fst], cellItems[snd]);
+                }
+            }
+        }
+    }
+
+    double getCellSize() const { return cellSize; }
+    size_t getCellsCnt() const { return cols * rows; }
+
+private:
+    size_t getAxisCell(const double cord, const size_t axisCellsCnt) const;
+};
+
+#endif // SPATIAL_GRID_H
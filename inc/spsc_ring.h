@@ -0,0 +1,48 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free single producer / single consumer ring of CAPACITY values. Pushing to a full ring fails
+// instead of waiting or overwriting, so the producer never blocks on a slow consumer and a value is
+// never read while it is being written.
+template <typename T, size_t CAPACITY>
+class SpscRing {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static const size_t INDEX_MASK = CAPACITY - 1;
+
+    T values[CAPACITY];
+
+    // running counts, kept apart so the two sides do not share a cache line
+    alignas(64) std::atomic<size_t> poppedCnt;
+    alignas(64) std::atomic<size_t> pushedCnt;
+
+public:
+    SpscRing(): poppedCnt(0), pushedCnt(0) {}
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // producer side, false when the ring is full
+    bool tryPush(const T &value) {
+        size_t curPushedCnt = pushedCnt.load(std::memory_order_relaxed);
+        if (curPushedCnt - poppedCnt.load(std::memory_order_acquire) == CAPACITY) return false;
+
+        values[curPushedCnt & INDEX_MASK] = value;
+        pushedCnt.store(curPushedCnt + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, false when the ring is empty
+    bool tryPop(T &value) {
+        size_t curPoppedCnt = poppedCnt.load(std::memory_order_relaxed);
+        if (curPoppedCnt == pushedCnt.load(std::memory_order_acquire)) return false;
+
+        value = values[curPoppedCnt & INDEX_MASK];
+        poppedCnt.store(curPoppedCnt + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,70 @@
+#ifndef SWEEP_AND_PRUNE_H
+#define SWEEP_AND_PRUNE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// newcomers are sorted on their own and merged in when there are more of them than this share of
+// the items kept from the previous update, insertion sort places them one by one otherwise
+static const double SWEEP_AND_PRUNE_MAX_INSERTED_SHARE = 0.05;
+
+// Sort and sweep broad phase along x. Every item is the square [x - r, x + r] x [y - r, y + r]
+// around its own radius, so one big item does not coarsen the search for all others as it does
+// with a uniform grid cell size.
+// Intervals stay sorted by their lower x end between updates: items are tracked by stable keys,
+// so after a step only the few intervals that overtook each other are moved by the insertion sort.
+class SweepAndPrune {
+    // sorted by minXs, one slot per item
+    std::vector<double> minXs;
+    std::vector<double> maxXs;
+    std::vector<double> minYs;
+    std::vector<double> maxYs;
+    std::vector<size_t> sortedItems;
+    std::vector<uint32_t> sortedKeys; // order the next update starts from
+
+    // scratch, kept to reuse capacity
+    std::vector<size_t> keyItems;
+    std::vector<bool> isItemPlaced;
+    std::vector<size_t> insertedItems;
+    std::vector<double> mergedMinXs;
+    std::vector<size_t> mergedItems;
+
+public:
+    void reserve(const size_t itemsCnt);
+
+    // Item i is centered at (xs[i], ys[i]) with half side radiuses[i] + margin. keys[i] identifies
+    // the item across updates while its index may change; keys are expected to be small and dense,
+    // and a key reused by another item only costs its first placement some extra moves.
+    void update
+    (
+        const double *xs, const double *ys, const double *radiuses, const uint32_t *keys,
+        const size_t itemsCnt, const double margin
+    );
+
+    // Calls pairHandle(i, j) once for every unordered pair of items whose squares overlap,
+    // touching borders included.
+    template <typename PairHandle>
+    void forEachCandidatePair(PairHandle &&pairHandle) const {
+        size_t itemsCnt = sortedItems.size();
+
+        for (size_t fst = 0; fst < itemsCnt; fst++) {
+            double fstMaxX = maxXs[fst];
+            double fstMinY = minYs[fst];
+            double fstMaxY = maxYs[fst];
+
+            for (size_t snd = fst + 1; snd < itemsCnt && minXs[snd] <= fstMaxX; snd++) {
+                if (minYs[snd] <= fstMaxY && fstMinY <= maxYs[snd])
+                    pairHandle(sortedItems[fst], sortedItems[snd]);
+            }
+        }
+    }
+
+    size_t size() const { return sortedItems.size(); }
+
+private:
+    void insertionSort();
+    void mergeInserted(const double *xs, const double *radiuses, const double margin);
+};
+
+#endif // SWEEP_AND_PRUNE_H
@@ -0,0 +1,64 @@
+#ifndef TIMESTEP_DRIVER_H
+#define TIMESTEP_DRIVER_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
+static const size_t TIMESTEP_DRIVER_MAX_SUBSTEPS_CNT = 8;
+
+// Turns measured wall time into a whole number of fixed simulation steps. Wall time scaled by
+// timeScale piles up in an accumulator drained fixedStepSecs at a time, so simulated speed does
+// not depend on how often the driver is polled. At most maxSubstepsCnt steps are owed at once:
+// time beyond that is dropped instead of caught up later, so an overloaded machine runs the
+// simulation slower rather than falling ever further behind.
+class TimestepDriver {
+    double fixedStepSecs;
+    size_t maxSubstepsCnt;
+    double timeScale;
+
+    double accumulatedSecs;
+    double droppedSecs;
+
+public:
+    explicit TimestepDriver(const double fixedStepSecs, const size_t maxSubstepsCnt=TIMESTEP_DRIVER_MAX_SUBSTEPS_CNT):
+        fixedStepSecs(fixedStepSecs), maxSubstepsCnt(maxSubstepsCnt), timeScale(1),
+        accumulatedSecs(0), droppedSecs(0)
+    {
+        assert(fixedStepSecs > 0);
+        assert(maxSubstepsCnt > 0);
+    }
+
+    double getFixedStepSecs() const { return fixedStepSecs; }
+
+    // simulated seconds per wall second, 0 pauses the simulation
+    double getTimeScale() const { return timeScale; }
+    void setTimeScale(const double timeScale) { this->timeScale = std::max(timeScale, 0.0); }
+
+    // simulated seconds given up by the catch-up cap
+    double getDroppedSecs() const { return droppedSecs; }
+
+    // wall seconds until the next step is owed, infinity while paused
+    double getSecsToNextStep() const {
+        if (timeScale == 0) return std::numeric_limits<double>::infinity();
+        return std::max(fixedStepSecs - accumulatedSecs, 0.0) / timeScale;
+    }
+
+    // feeds wallDeltaSecs of measured wall time, returns how many fixed steps are owed now
+    size_t advance(const double wallDeltaSecs) {
+        accumulatedSecs += std::max(wallDeltaSecs, 0.0) * timeScale;
+
+        double maxAccumulatedSecs = maxSubstepsCnt * fixedStepSecs;
+        if (accumulatedSecs > maxAccumulatedSecs) {
+            droppedSecs += accumulatedSecs - maxAccumulatedSecs;
+            accumulatedSecs = maxAccumulatedSecs;
+        }
+
+        size_t stepsCnt = std::min(size_t(accumulatedSecs / fixedStepSecs), maxSubstepsCnt);
+        accumulatedSecs = std::max(accumulatedSecs - stepsCnt * fixedStepSecs, 0.0);
+        return stepsCnt;
+    }
+};
+
+#endif // TIMESTEP_DRIVER_H
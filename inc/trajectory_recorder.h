@@ -0,0 +1,181 @@
+#ifndef TRAJECTORY_RECORDER_H
+#define TRAJECTORY_RECORDER_H
+
+#include "molecule_store.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const uint64_t TRAJECTORY_FILE_MAGIC = 0x4A41525446524F43; // "CORFTRAJ" on little-endian hosts
+static const uint32_t TRAJECTORY_FILE_VERSION = 2;
+static const double TRAJECTORY_POSITION_QUANTUM = 1.0 / 1024;
+static const double TRAJECTORY_SPEED_QUANTUM = 1.0 / 1024;
+static const size_t TRAJECTORY_FRAMES_IN_FLIGHT_CNT = 4;
+
+enum TrajectoryColumn {
+    HANDLES_COLUMN,
+    TYPES_COLUMN,
+    MASSES_COLUMN,
+    XS_COLUMN,
+    YS_COLUMN,
+    SPEED_XS_COLUMN,
+    SPEED_YS_COLUMN,
+};
+
+static const size_t TRAJECTORY_COLUMNS_CNT = 7;
+
+// Trajectory file layout: this header, then one chunk per recorded tick. A chunk is a
+// TrajectoryFrameHeader followed by its columns in TrajectoryColumn order.
+//   handles:  zigzag varint delta from the previous molecule of the chunk
+//   types:    one byte per molecule
+//   others:   masses as they are, positions and speeds rounded to their quantum; each is a zigzag
+//             varint delta from the same handle in the previous chunk, or from 0 when the handle
+//             was not in it
+// Molecules barely move between two recorded ticks, so most deltas fit in a byte or two.
+// The frame header also carries handlesEnd, one past the largest handle of the chunk: the reader
+// sizes its per-handle baselines by it and rejects any decoded handle outside it, so a damaged
+// handle varint cannot make it allocate for a bogus handle.
+struct TrajectoryFileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    double positionQuantum;
+    double speedQuantum;
+    uint64_t recordEveryTicks;
+};
+
+struct TrajectoryFrameHeader {
+    uint64_t tickIndex;
+    double timePoint;
+    uint64_t moleculesCnt;
+    uint64_t handlesEnd; // 0 for an empty chunk
+    uint64_t columnSizes[TRAJECTORY_COLUMNS_CNT];
+};
+
+// One recorded tick, decoded: positions and speeds are multiples of their quantum.
+struct TrajectoryFrame {
+    uint64_t tickIndex = 0;
+    double timePoint = 0;
+
+    std::vector<MoleculeHandle> handles;
+    std::vector<MoleculeTypes> types;
+    std::vector<int> masses;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> speedXs;
+    std::vector<double> speedYs;
+
+    size_t size() const { return handles.size(); }
+
+    void resize(const size_t moleculesCnt) {
+        handles.resize(moleculesCnt);
+        types.resize(moleculesCnt);
+        masses.resize(moleculesCnt);
+        xs.resize(moleculesCnt);
+        ys.resize(moleculesCnt);
+        speedXs.resize(moleculesCnt);
+        speedYs.resize(moleculesCnt);
+    }
+};
+
+// Per-handle baselines of the delta coding, kept identically by the writer and the reader.
+class TrajectoryDeltaBaselines {
+    uint64_t framesCnt = 0;
+    std::vector<uint64_t> handleNextFrames; // number of the frame after the last one with the handle
+    std::vector<int64_t> columnBaselines[TRAJECTORY_COLUMNS_CNT];
+
+public:
+    void beginFrame(const MoleculeHandle *handles, const size_t moleculesCnt);
+
+    // value of handle in column in the previous frame, 0 when the handle was not in it
+    int64_t getBaseline(const TrajectoryColumn column, const MoleculeHandle handle) const {
+        return (handleNextFrames[handle] == framesCnt) ? columnBaselines[column][handle] : 0;
+    }
+
+    void setBaseline(const TrajectoryColumn column, const MoleculeHandle handle, const int64_t value) {
+        columnBaselines[column][handle] = value;
+    }
+
+    void finishFrame(const MoleculeHandle *handles, const size_t moleculesCnt);
+};
+
+// Streams every recordEveryTicks-th tick to a chunked columnar file. The simulation thread only
+// copies the store into one of TRAJECTORY_FRAMES_IN_FLIGHT_CNT preallocated frames; encoding and
+// disk writes happen on the recorder's own thread. When every frame is still queued the tick is
+// dropped and counted instead of waiting, so a slow disk never stalls the simulation.
+class TrajectoryRecorder {
+    std::ofstream stream;
+    size_t recordEveryTicks;
+    uint64_t ticksCnt; // simulation thread only
+
+    std::vector<TrajectoryFrame> frames;
+    std::vector<size_t> freeFrameSlots;
+    std::vector<size_t> queuedFrameSlots; // ring of frames.size()
+    size_t queuedFramesHead;
+    size_t queuedFramesCnt;
+    bool isStopping;
+
+    std::mutex framesMutex;
+    std::condition_variable framesCondition;
+
+    std::atomic<size_t> recordedFramesCnt;
+    std::atomic<size_t> droppedFramesCnt;
+    std::atomic<bool> isWriteFailed;
+
+    // writer thread only
+    TrajectoryDeltaBaselines deltaBaselines;
+    std::vector<uint8_t> columnBytes[TRAJECTORY_COLUMNS_CNT];
+
+    std::thread writerThread;
+
+public:
+    TrajectoryRecorder
+    (
+        const std::string &path, const size_t recordEveryTicks,
+        const size_t framesInFlightCnt=TRAJECTORY_FRAMES_IN_FLIGHT_CNT
+    );
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+    TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+
+    bool isOpen() const { return writerThread.joinable(); }
+    bool isFailed() const { return !isOpen() || isWriteFailed.load(std::memory_order_relaxed); }
+
+    size_t getRecordedFramesCnt() const { return recordedFramesCnt.load(std::memory_order_relaxed); }
+    size_t getDroppedFramesCnt() const { return droppedFramesCnt.load(std::memory_order_relaxed); }
+
+    // simulation thread, once per tick
+    void onTick(const MoleculeStore &moleculeStore, const double timePoint);
+
+private:
+    void writerLoop();
+    void writeFrame(const TrajectoryFrame &frame);
+};
+
+// Decodes a trajectory file frame by frame, for offline analysis.
+class TrajectoryReader {
+    std::ifstream stream;
+    TrajectoryFileHeader header;
+
+    TrajectoryDeltaBaselines deltaBaselines;
+    std::vector<uint8_t> columnBytes[TRAJECTORY_COLUMNS_CNT];
+
+public:
+    explicit TrajectoryReader(const std::string &path);
+
+    bool isOpen() const { return bool(stream); }
+    const TrajectoryFileHeader &getHeader() const { return header; }
+
+    // false at the end of the file or on a damaged chunk
+    bool readFrame(TrajectoryFrame &frame);
+};
+
+#endif // TRAJECTORY_RECORDER_H
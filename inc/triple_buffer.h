@@ -0,0 +1,47 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer / single consumer triple buffer. The producer fills its back slot and
+// publishes it; the consumer takes the latest published slot. Neither side ever waits: slots are
+// swapped through one atomic index, and a slot is only touched by the side owning it.
+// Stale slots keep their contents, so slots holding vectors stop allocating once warmed up.
+template <typename T>
+class TripleBuffer {
+    static const uint8_t SLOT_INDEX_MASK = 0x3;
+    static const uint8_t FRESH_SLOT_BIT = 0x4;
+
+    T slotValues[3];
+
+    uint8_t backSlot;
+    std::atomic<uint8_t> middleSlot;
+    uint8_t frontSlot;
+
+public:
+    TripleBuffer(): backSlot(0), middleSlot(1), frontSlot(2) {}
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // producer side
+    T &getBackSlot() { return slotValues[backSlot]; }
+
+    void publish() {
+        backSlot = middleSlot.exchange(backSlot | FRESH_SLOT_BIT, std::memory_order_acq_rel) & SLOT_INDEX_MASK;
+    }
+
+    // consumer side
+    bool hasFreshSlot() const { return middleSlot.load(std::memory_order_relaxed) & FRESH_SLOT_BIT; }
+
+    // latest published slot, stays valid until the next acquire
+    const T &acquireFrontSlot() {
+        if (hasFreshSlot())
+            frontSlot = middleSlot.exchange(frontSlot, std::memory_order_acq_rel) & SLOT_INDEX_MASK;
+
+        return slotValues[frontSlot];
+    }
+};
+
+#endif // TRIPLE_BUFFER_H
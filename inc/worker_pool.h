@@ -0,0 +1,73 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+static const size_t WORKER_POOL_CHUNKS_PER_THREAD = 4;
+
+// Fixed set of threads running one job at a time. The calling thread takes part in every job,
+// so a pool of threadsCnt threads spawns threadsCnt - 1 workers. Jobs are split into chunks
+// which threads grab in turn; parallelFor returns when every chunk is done.
+class WorkerPool {
+    typedef void (*ChunkFunc)(void *context, const size_t chunkIndex);
+
+    std::vector<std::thread> workers;
+
+    std::mutex jobMutex;
+    std::condition_variable jobStartedCondition;
+    std::condition_variable jobFinishedCondition;
+
+    ChunkFunc jobChunkFunc;
+    void *jobContext;
+    size_t jobChunksCnt;
+    std::atomic<size_t> jobNextChunk;
+    size_t busyWorkersCnt;
+    uint64_t jobGeneration;
+    bool stopping;
+
+public:
+    explicit WorkerPool(const size_t threadsCnt);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    size_t getThreadsCnt() const { return workers.size() + 1; }
+
+    // chunkHandle(chunkIndex) for every chunkIndex in [0, chunksCnt)
+    template <typename ChunkHandle>
+    void parallelForChunks(const size_t chunksCnt, ChunkHandle &&chunkHandle) {
+        runJob(chunksCnt, [](void *context, const size_t chunkIndex) {
+            (*static_cast<std::remove_reference_t<ChunkHandle> *>(context))(chunkIndex);
+        }, &chunkHandle);
+    }
+
+    // rangeHandle(begin, end) over disjoint ranges covering [0, itemsCnt)
+    template <typename RangeHandle>
+    void parallelFor(const size_t itemsCnt, RangeHandle &&rangeHandle) {
+        size_t chunksCnt = std::min(itemsCnt, getThreadsCnt() * WORKER_POOL_CHUNKS_PER_THREAD);
+        if (chunksCnt == 0) return;
+
+        size_t chunkSize = (itemsCnt + chunksCnt - 1) / chunksCnt;
+        parallelForChunks(chunksCnt, [&](const size_t chunkIndex) {
+            size_t begin = chunkIndex * chunkSize;
+            size_t end = std::min(itemsCnt, begin + chunkSize);
+            if (begin < end) rangeHandle(begin, end);
+        });
+    }
+
+private:
+    void runJob(const size_t chunksCnt, ChunkFunc chunkFunc, void *context);
+    void runJobChunks();
+    void workerLoop();
+};
+
+#endif // WORKER_POOL_H
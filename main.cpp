@@ -60,14 +60,9 @@ int main(int argc, char** argv){
     
 
     
-    // RecorderWidget *molecule_recorder = new RecorderWidget;
-    // mainLayout->addWidget(molecule_recorder, /*stretch=*/1);  // narrower
+    RecorderWidget *recorder = new RecorderWidget(reactor->getReactorCoreAdapter());
+    mainLayout->addWidget(recorder, /*stretch=*/1);
 
-    // RecorderWidget *system_ene.rgy_recorder = new RecorderWidget;
-    // mainLayout->addWidget(system_energy_recorder, /*stretch=*/1);  // narrower
-
-    
-    
     window.resize(800, 800);
     window.show();
     return app.exec();
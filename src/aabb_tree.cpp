@@ -0,0 +1,243 @@
+#include "aabb_tree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+void DynamicAabbTree::reserve(const size_t itemsCnt) {
+    // a tree over n leaves has n - 1 inner nodes
+    nodes.reserve(2 * itemsCnt);
+    freeNodes.reserve(2 * itemsCnt);
+    keyLeaves.reserve(itemsCnt);
+    isKeyPresent.reserve(itemsCnt);
+    traversalStack.reserve(itemsCnt);
+}
+
+void DynamicAabbTree::update
+(
+    const double *xs, const double *ys, const double *speedXs, const double *speedYs,
+    const double *radiuses, const uint32_t *keys, const size_t itemsCnt,
+    const double margin, const double deltaSecs
+) {
+    uint32_t maxKey = 0;
+    for (size_t i = 0; i < itemsCnt; i++)
+        maxKey = std::max(maxKey, keys[i]);
+
+    if (keyLeaves.size() <= maxKey) keyLeaves.resize(size_t(maxKey) + 1, NONE_AABB_TREE_NODE);
+
+    isKeyPresent.assign(keyLeaves.size(), false);
+    for (size_t i = 0; i < itemsCnt; i++)
+        isKeyPresent[keys[i]] = true;
+
+    // leaves of items that are gone, e.g. died in a reaction
+    for (size_t key = 0; key < keyLeaves.size(); key++) {
+        if (keyLeaves[key] == NONE_AABB_TREE_NODE || isKeyPresent[key]) continue;
+
+        removeLeaf(keyLeaves[key]);
+        freeNode(keyLeaves[key]);
+        keyLeaves[key] = NONE_AABB_TREE_NODE;
+    }
+
+    for (size_t i = 0; i < itemsCnt; i++) {
+        double halfSide = radiuses[i] + margin;
+        double minX = xs[i] - halfSide;
+        double minY = ys[i] - halfSide;
+        double maxX = xs[i] + halfSide;
+        double maxY = ys[i] + halfSide;
+
+        size_t leaf = keyLeaves[keys[i]];
+        if (leaf != NONE_AABB_TREE_NODE) {
+            nodes[leaf].item = i;
+
+            const Node &node = nodes[leaf];
+            if (node.minX <= minX && node.minY <= minY && maxX <= node.maxX && maxY <= node.maxY) continue;
+
+            removeLeaf(leaf);
+        } else {
+            leaf = allocateNode();
+            keyLeaves[keys[i]] = leaf;
+            nodes[leaf].item = i;
+            nodes[leaf].key = keys[i];
+        }
+
+        double displacementX = AABB_TREE_DISPLACEMENT_MULTIPLIER * speedXs[i] * deltaSecs;
+        double displacementY = AABB_TREE_DISPLACEMENT_MULTIPLIER * speedYs[i] * deltaSecs;
+
+        Node &node = nodes[leaf];
+        node.minX = minX - AABB_TREE_FAT_EXTENSION + std::min(displacementX, 0.0);
+        node.minY = minY - AABB_TREE_FAT_EXTENSION + std::min(displacementY, 0.0);
+        node.maxX = maxX + AABB_TREE_FAT_EXTENSION + std::max(displacementX, 0.0);
+        node.maxY = maxY + AABB_TREE_FAT_EXTENSION + std::max(displacementY, 0.0);
+
+        insertLeaf(leaf);
+    }
+}
+
+double DynamicAabbTree::getUnionPerimeter(const Node &fst, const Node &snd) {
+    double width = std::max(fst.maxX, snd.maxX) - std::min(fst.minX, snd.minX);
+    double height = std::max(fst.maxY, snd.maxY) - std::min(fst.minY, snd.minY);
+
+    return 2 * (width + height);
+}
+
+void DynamicAabbTree::setUnionBox(const size_t node, const size_t fst, const size_t snd) {
+    nodes[node].minX = std::min(nodes[fst].minX, nodes[snd].minX);
+    nodes[node].minY = std::min(nodes[fst].minY, nodes[snd].minY);
+    nodes[node].maxX = std::max(nodes[fst].maxX, nodes[snd].maxX);
+    nodes[node].maxY = std::max(nodes[fst].maxY, nodes[snd].maxY);
+}
+
+size_t DynamicAabbTree::allocateNode() {
+    size_t node = 0;
+    if (freeNodes.empty()) {
+        node = nodes.size();
+        nodes.emplace_back();
+    } else {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    }
+
+    nodes[node].parent = NONE_AABB_TREE_NODE;
+    nodes[node].fstChild = NONE_AABB_TREE_NODE;
+    nodes[node].sndChild = NONE_AABB_TREE_NODE;
+    nodes[node].height = 0;
+
+    return node;
+}
+
+void DynamicAabbTree::freeNode(const size_t node) {
+    freeNodes.push_back(node);
+}
+
+void DynamicAabbTree::replaceChild(const size_t parent, const size_t oldChild, const size_t newChild) {
+    if (parent == NONE_AABB_TREE_NODE) {
+        root = newChild;
+    } else if (nodes[parent].fstChild == oldChild) {
+        nodes[parent].fstChild = newChild;
+    } else {
+        assert(nodes[parent].sndChild == oldChild);
+        nodes[parent].sndChild = newChild;
+    }
+}
+
+void DynamicAabbTree::insertLeaf(const size_t leaf) {
+    if (root == NONE_AABB_TREE_NODE) {
+        root = leaf;
+        nodes[root].parent = NONE_AABB_TREE_NODE;
+        return;
+    }
+
+    // Descend towards the sibling that minimizes the total perimeter of the inner nodes: the new
+    // parent costs the combined box, and every ancestor inherits the growth of its own box.
+    size_t sibling = root;
+    while (!nodes[sibling].isLeaf()) {
+        const Node &node = nodes[sibling];
+
+        double combinedPerimeter = getUnionPerimeter(node, nodes[leaf]);
+        double cost = 2 * combinedPerimeter;
+        double inheritanceCost = 2 * (combinedPerimeter - getPerimeter(node));
+
+        auto getDescendCost = [&](const size_t child) {
+            double childCost = getUnionPerimeter(nodes[child], nodes[leaf]);
+            if (!nodes[child].isLeaf()) childCost -= getPerimeter(nodes[child]);
+
+            return childCost + inheritanceCost;
+        };
+
+        double fstCost = getDescendCost(node.fstChild);
+        double sndCost = getDescendCost(node.sndChild);
+
+        if (cost < fstCost && cost < sndCost) break;
+        sibling = (fstCost < sndCost) ? node.fstChild : node.sndChild;
+    }
+
+    size_t oldParent = nodes[sibling].parent;
+    size_t newParent = allocateNode();
+
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].fstChild = sibling;
+    nodes[newParent].sndChild = leaf;
+    nodes[newParent].height = nodes[sibling].height + 1;
+    setUnionBox(newParent, sibling, leaf);
+
+    replaceChild(oldParent, sibling, newParent);
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    refitAncestors(oldParent);
+}
+
+void DynamicAabbTree::removeLeaf(const size_t leaf) {
+    if (leaf == root) {
+        root = NONE_AABB_TREE_NODE;
+        return;
+    }
+
+    size_t parent = nodes[leaf].parent;
+    size_t grandParent = nodes[parent].parent;
+    size_t sibling = (nodes[parent].fstChild == leaf) ? nodes[parent].sndChild : nodes[parent].fstChild;
+
+    replaceChild(grandParent, parent, sibling);
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    refitAncestors(grandParent);
+}
+
+void DynamicAabbTree::refitAncestors(size_t node) {
+    while (node != NONE_AABB_TREE_NODE) {
+        node = balance(node);
+
+        size_t fstChild = nodes[node].fstChild;
+        size_t sndChild = nodes[node].sndChild;
+
+        nodes[node].height = 1 + std::max(nodes[fstChild].height, nodes[sndChild].height);
+        setUnionBox(node, fstChild, sndChild);
+
+        node = nodes[node].parent;
+    }
+}
+
+// If one child of the node is more than one level taller than the other, the taller child takes
+// its place and the node adopts the shorter of its grandchildren. Returns the subtree root.
+size_t DynamicAabbTree::balance(const size_t node) {
+    if (nodes[node].isLeaf() || nodes[node].height < 2) return node;
+
+    size_t fstChild = nodes[node].fstChild;
+    size_t sndChild = nodes[node].sndChild;
+    long heightDiff = long(nodes[sndChild].height) - long(nodes[fstChild].height);
+
+    if (heightDiff >= -1 && heightDiff <= 1) return node;
+
+    // the taller child rises, the other one stays in place
+    bool isSndRising = heightDiff > 1;
+    size_t rising = isSndRising ? sndChild : fstChild;
+    size_t staying = isSndRising ? fstChild : sndChild;
+
+    size_t risingFstChild = nodes[rising].fstChild;
+    size_t risingSndChild = nodes[rising].sndChild;
+
+    nodes[rising].fstChild = node;
+    nodes[rising].parent = nodes[node].parent;
+    nodes[node].parent = rising;
+    replaceChild(nodes[rising].parent, node, rising);
+
+    // the taller grandchild stays with the rising node, the shorter one moves down to the node
+    bool isFstGrandchildTaller = nodes[risingFstChild].height > nodes[risingSndChild].height;
+    size_t keptGrandchild = isFstGrandchildTaller ? risingFstChild : risingSndChild;
+    size_t movedGrandchild = isFstGrandchildTaller ? risingSndChild : risingFstChild;
+
+    nodes[rising].sndChild = keptGrandchild;
+    if (isSndRising) nodes[node].sndChild = movedGrandchild;
+    else             nodes[node].fstChild = movedGrandchild;
+    nodes[movedGrandchild].parent = node;
+
+    setUnionBox(node, staying, movedGrandchild);
+    nodes[node].height = 1 + std::max(nodes[staying].height, nodes[movedGrandchild].height);
+
+    setUnionBox(rising, node, keptGrandchild);
+    nodes[rising].height = 1 + std::max(nodes[node].height, nodes[keptGrandchild].height);
+
+    return rising;
+}
@@ -0,0 +1,254 @@
+#include "box_integrator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#ifdef SIMD_ISA_X86
+#include <immintrin.h>
+#endif
+
+// Per axis, with [lo, lo + L] the box, u the low wall speed and k the number of crossed walls:
+//   p' = p + v dt - lo,  k = floor(p' / L),  h = floor(k / 2),  parity = k - 2 h,  f = p' - k L
+//   p = lo + clamp(f + parity (L - 2 f), 0, L),  v = (1 - 2 parity) (v + 2 u h)
+// |h| is the number of low wall hits, each of them adds 2u to the speed in the direction it had
+// before the hit. floor, clamp and the parity arithmetic are exact, the rest is evaluated in
+// the same order by every kernel (the file is built with -ffp-contract=off).
+// Impulses: the high wall is hit |k| - |h| times, each hit taking 2 m |v|; both walls of the axis
+// together take m (v - v'), which leaves the low wall the difference.
+
+// momentum the high wall of an axis received and the one both walls received together
+struct AxisImpulses {
+    double highWall = 0;
+    double bothWalls = 0;
+};
+
+
+template <bool IsImpulseAccumulated>
+static void integrateAxisScalar
+(
+    double *cords, double *speeds, const int *masses, const size_t firstMolecule, const size_t moleculesCnt,
+    const double lowWall, const double side, const double lowWallSpeed, const double deltaSecs,
+    AxisImpulses &impulses
+) {
+    double lowWallSpeed2 = 2 * lowWallSpeed;
+
+    for (size_t i = firstMolecule; i < moleculesCnt; i++) {
+        double movedCord = cords[i] + speeds[i] * deltaSecs - lowWall;
+        double wallHitsCnt = std::floor(movedCord / side);
+        double halfWallHitsCnt = std::floor(wallHitsCnt * 0.5);
+        double parity = wallHitsCnt - 2 * halfWallHitsCnt;
+        double foldedCord = movedCord - wallHitsCnt * side;
+        double newSpeed = (1 - 2 * parity) * (speeds[i] + lowWallSpeed2 * halfWallHitsCnt);
+
+        if constexpr (IsImpulseAccumulated) {
+            double mass = masses[i];
+            double highWallHitsCnt = std::abs(wallHitsCnt) - std::abs(halfWallHitsCnt);
+
+            impulses.highWall += 2 * mass * std::abs(speeds[i]) * highWallHitsCnt;
+            impulses.bothWalls += mass * (speeds[i] - newSpeed);
+        }
+
+        cords[i] = lowWall + std::min(std::max(foldedCord + parity * (side - 2 * foldedCord), 0.0), side);
+        speeds[i] = newSpeed;
+    }
+}
+
+#ifdef SIMD_ISA_X86
+
+__attribute__((target("avx2")))
+static double sumLanesAvx2(const __m256d vec) {
+    double lanes[4];
+    _mm256_storeu_pd(lanes, vec);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+template <bool IsImpulseAccumulated>
+__attribute__((target("avx2")))
+static void integrateAxisAvx2
+(
+    double *cords, double *speeds, const int *masses, const size_t moleculesCnt,
+    const double lowWall, const double side, const double lowWallSpeed, const double deltaSecs,
+    AxisImpulses &impulses
+) {
+    static const size_t LANES_CNT = 4;
+
+    const __m256d lowWallVec = _mm256_set1_pd(lowWall);
+    const __m256d sideVec = _mm256_set1_pd(side);
+    const __m256d lowWallSpeed2Vec = _mm256_set1_pd(2 * lowWallSpeed);
+    const __m256d deltaSecsVec = _mm256_set1_pd(deltaSecs);
+    const __m256d zeroVec = _mm256_setzero_pd();
+    const __m256d halfVec = _mm256_set1_pd(0.5);
+    const __m256d oneVec = _mm256_set1_pd(1);
+    const __m256d twoVec = _mm256_set1_pd(2);
+    const __m256d signMaskVec = _mm256_set1_pd(-0.0);
+
+    __m256d highWallImpulseVec = _mm256_setzero_pd();
+    __m256d bothWallsImpulseVec = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + LANES_CNT <= moleculesCnt; i += LANES_CNT) {
+        __m256d cord = _mm256_loadu_pd(cords + i);
+        __m256d speed = _mm256_loadu_pd(speeds + i);
+
+        __m256d movedCord = _mm256_sub_pd(_mm256_add_pd(cord, _mm256_mul_pd(speed, deltaSecsVec)), lowWallVec);
+        __m256d wallHitsCnt = _mm256_floor_pd(_mm256_div_pd(movedCord, sideVec));
+        __m256d halfWallHitsCnt = _mm256_floor_pd(_mm256_mul_pd(wallHitsCnt, halfVec));
+        __m256d parity = _mm256_sub_pd(wallHitsCnt, _mm256_mul_pd(twoVec, halfWallHitsCnt));
+        __m256d foldedCord = _mm256_sub_pd(movedCord, _mm256_mul_pd(wallHitsCnt, sideVec));
+
+        __m256d newCord = _mm256_add_pd(foldedCord, _mm256_mul_pd(parity, _mm256_sub_pd(sideVec, _mm256_mul_pd(twoVec, foldedCord))));
+        // operand order keeps std::max/std::min semantics for NaN
+        newCord = _mm256_add_pd(lowWallVec, _mm256_min_pd(sideVec, _mm256_max_pd(zeroVec, newCord)));
+
+        __m256d newSpeed = _mm256_mul_pd(_mm256_sub_pd(oneVec, _mm256_mul_pd(twoVec, parity)),
+                                         _mm256_add_pd(speed, _mm256_mul_pd(lowWallSpeed2Vec, halfWallHitsCnt)));
+
+        if constexpr (IsImpulseAccumulated) {
+            __m256d mass = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(masses + i)));
+            __m256d highWallHitsCnt = _mm256_sub_pd(_mm256_andnot_pd(signMaskVec, wallHitsCnt), _mm256_andnot_pd(signMaskVec, halfWallHitsCnt));
+
+            highWallImpulseVec = _mm256_add_pd(highWallImpulseVec,
+                _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(twoVec, mass), _mm256_andnot_pd(signMaskVec, speed)), highWallHitsCnt));
+            bothWallsImpulseVec = _mm256_add_pd(bothWallsImpulseVec, _mm256_mul_pd(mass, _mm256_sub_pd(speed, newSpeed)));
+        }
+
+        _mm256_storeu_pd(cords + i, newCord);
+        _mm256_storeu_pd(speeds + i, newSpeed);
+    }
+
+    if constexpr (IsImpulseAccumulated) {
+        impulses.highWall += sumLanesAvx2(highWallImpulseVec);
+        impulses.bothWalls += sumLanesAvx2(bothWallsImpulseVec);
+    }
+
+    integrateAxisScalar<IsImpulseAccumulated>(cords, speeds, masses, /*firstMolecule=*/i, moleculesCnt,
+                                              lowWall, side, lowWallSpeed, deltaSecs, impulses);
+}
+
+template <bool IsImpulseAccumulated>
+__attribute__((target("avx512f")))
+static void integrateAxisAvx512
+(
+    double *cords, double *speeds, const int *masses, const size_t moleculesCnt,
+    const double lowWall, const double side, const double lowWallSpeed, const double deltaSecs,
+    AxisImpulses &impulses
+) {
+    static const size_t LANES_CNT = 8;
+    static const int FLOOR_ROUNDING = _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC;
+
+    const __m512d lowWallVec = _mm512_set1_pd(lowWall);
+    const __m512d sideVec = _mm512_set1_pd(side);
+    const __m512d lowWallSpeed2Vec = _mm512_set1_pd(2 * lowWallSpeed);
+    const __m512d deltaSecsVec = _mm512_set1_pd(deltaSecs);
+    const __m512d zeroVec = _mm512_setzero_pd();
+    const __m512d halfVec = _mm512_set1_pd(0.5);
+    const __m512d oneVec = _mm512_set1_pd(1);
+    const __m512d twoVec = _mm512_set1_pd(2);
+
+    // lanes past the end load zero masses, so they add nothing
+    __m512d highWallImpulseVec = _mm512_setzero_pd();
+    __m512d bothWallsImpulseVec = _mm512_setzero_pd();
+
+    for (size_t i = 0; i < moleculesCnt; i += LANES_CNT) {
+        size_t lanesCnt = std::min(LANES_CNT, moleculesCnt - i);
+        __mmask8 lanesMask = __mmask8((1u << lanesCnt) - 1);
+
+        __m512d cord = _mm512_maskz_loadu_pd(lanesMask, cords + i);
+        __m512d speed = _mm512_maskz_loadu_pd(lanesMask, speeds + i);
+
+        __m512d movedCord = _mm512_sub_pd(_mm512_add_pd(cord, _mm512_mul_pd(speed, deltaSecsVec)), lowWallVec);
+        __m512d wallHitsCnt = _mm512_roundscale_pd(_mm512_div_pd(movedCord, sideVec), FLOOR_ROUNDING);
+        __m512d halfWallHitsCnt = _mm512_roundscale_pd(_mm512_mul_pd(wallHitsCnt, halfVec), FLOOR_ROUNDING);
+        __m512d parity = _mm512_sub_pd(wallHitsCnt, _mm512_mul_pd(twoVec, halfWallHitsCnt));
+        __m512d foldedCord = _mm512_sub_pd(movedCord, _mm512_mul_pd(wallHitsCnt, sideVec));
+
+        __m512d newCord = _mm512_add_pd(foldedCord, _mm512_mul_pd(parity, _mm512_sub_pd(sideVec, _mm512_mul_pd(twoVec, foldedCord))));
+        newCord = _mm512_add_pd(lowWallVec, _mm512_min_pd(sideVec, _mm512_max_pd(zeroVec, newCord)));
+
+        __m512d newSpeed = _mm512_mul_pd(_mm512_sub_pd(oneVec, _mm512_mul_pd(twoVec, parity)),
+                                         _mm512_add_pd(speed, _mm512_mul_pd(lowWallSpeed2Vec, halfWallHitsCnt)));
+
+        if constexpr (IsImpulseAccumulated) {
+            __m512d mass = _mm512_cvtepi32_pd(_mm512_castsi512_si256(_mm512_maskz_loadu_epi32(__mmask16(lanesMask), masses + i)));
+            __m512d highWallHitsCnt = _mm512_sub_pd(_mm512_abs_pd(wallHitsCnt), _mm512_abs_pd(halfWallHitsCnt));
+
+            highWallImpulseVec = _mm512_add_pd(highWallImpulseVec,
+                _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(twoVec, mass), _mm512_abs_pd(speed)), highWallHitsCnt));
+            bothWallsImpulseVec = _mm512_add_pd(bothWallsImpulseVec, _mm512_mul_pd(mass, _mm512_sub_pd(speed, newSpeed)));
+        }
+
+        _mm512_mask_storeu_pd(cords + i, lanesMask, newCord);
+        _mm512_mask_storeu_pd(speeds + i, lanesMask, newSpeed);
+    }
+
+    if constexpr (IsImpulseAccumulated) {
+        impulses.highWall += _mm512_reduce_add_pd(highWallImpulseVec);
+        impulses.bothWalls += _mm512_reduce_add_pd(bothWallsImpulseVec);
+    }
+}
+
+#endif // SIMD_ISA_X86
+
+
+template <bool IsImpulseAccumulated>
+static void integrateAxis
+(
+    double *cords, double *speeds, const int *masses, const size_t moleculesCnt,
+    const double lowWall, const double side, const double lowWallSpeed, const double deltaSecs,
+    AxisImpulses &impulses, const SimdIsa isa
+) {
+    switch (isa) {
+#ifdef SIMD_ISA_X86
+        case AVX512_SIMD_ISA:
+            integrateAxisAvx512<IsImpulseAccumulated>(cords, speeds, masses, moleculesCnt, lowWall, side, lowWallSpeed, deltaSecs, impulses);
+            break;
+        case AVX2_SIMD_ISA:
+            integrateAxisAvx2<IsImpulseAccumulated>(cords, speeds, masses, moleculesCnt, lowWall, side, lowWallSpeed, deltaSecs, impulses);
+            break;
+#endif
+        case SCALAR_SIMD_ISA:
+            integrateAxisScalar<IsImpulseAccumulated>(cords, speeds, masses, /*firstMolecule=*/0, moleculesCnt,
+                                                      lowWall, side, lowWallSpeed, deltaSecs, impulses);
+            break;
+        default: assert(0 && "unknown SimdIsa");
+    }
+}
+
+void integrateBoxMovement
+(
+    double *xs, double *ys, double *speedXs, double *speedYs, const size_t moleculesCnt,
+    const double leftWallX, const double rightWallX, const double height, const double leftWallSpeed,
+    const double deltaSecs, const SimdIsa isa
+) {
+    assert(rightWallX > leftWallX && height > 0);
+    assert(isSimdIsaSupported(isa));
+
+    AxisImpulses unusedImpulses;
+    integrateAxis<false>(xs, speedXs, /*masses=*/nullptr, moleculesCnt, leftWallX, rightWallX - leftWallX, leftWallSpeed,
+                         deltaSecs, unusedImpulses, isa);
+    integrateAxis<false>(ys, speedYs, /*masses=*/nullptr, moleculesCnt, /*lowWall=*/0, height, /*lowWallSpeed=*/0,
+                         deltaSecs, unusedImpulses, isa);
+}
+
+void integrateBoxMovement
+(
+    double *xs, double *ys, double *speedXs, double *speedYs, const int *masses, const size_t moleculesCnt,
+    const double leftWallX, const double rightWallX, const double height, const double leftWallSpeed,
+    const double deltaSecs, BoxWallImpulses &wallImpulses, const SimdIsa isa
+) {
+    assert(rightWallX > leftWallX && height > 0);
+    assert(isSimdIsaSupported(isa));
+
+    AxisImpulses xImpulses;
+    AxisImpulses yImpulses;
+    integrateAxis<true>(xs, speedXs, masses, moleculesCnt, leftWallX, rightWallX - leftWallX, leftWallSpeed,
+                        deltaSecs, xImpulses, isa);
+    integrateAxis<true>(ys, speedYs, masses, moleculesCnt, /*lowWall=*/0, height, /*lowWallSpeed=*/0,
+                        deltaSecs, yImpulses, isa);
+
+    wallImpulses.leftWall += xImpulses.highWall - xImpulses.bothWalls;
+    wallImpulses.rightWall += xImpulses.highWall;
+    wallImpulses.lowWall += yImpulses.highWall - yImpulses.bothWalls;
+    wallImpulses.highWall += yImpulses.highWall;
+}
@@ -0,0 +1,128 @@
+#include "core_observables.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+void CoreObservables::resetMolecules() {
+    std::fill(moleculeTypeCnts, moleculeTypeCnts + MOLECULE_TYPES_CNT, 0);
+    totalMass = 0;
+    doubledKineticEnergy = 0;
+    momentumX = 0;
+    momentumY = 0;
+}
+
+void CoreObservables::reset() {
+    resetMolecules();
+
+    std::fill(stepWallImpulses, stepWallImpulses + WALLS_CNT, 0);
+    std::fill(wallImpulses, wallImpulses + WALLS_CNT, 0);
+
+    averagedSecs = 0;
+    std::fill(wallPressures, wallPressures + WALLS_CNT, 0);
+    pressure = 0;
+}
+
+void CoreObservables::recount(const MoleculeStore &moleculeStore) {
+    reset();
+    recountMolecules(moleculeStore);
+}
+
+void CoreObservables::recountMolecules(const MoleculeStore &moleculeStore) {
+    resetMolecules();
+
+    for (size_t moleculeIndex = 0; moleculeIndex < moleculeStore.size(); moleculeIndex++) {
+        if (moleculeStore.getPhysicalState(moleculeIndex) != DEATH)
+            addMolecule(moleculeStore, moleculeIndex);
+    }
+}
+
+void CoreObservables::accountMolecule(const MoleculeStore &moleculeStore, const size_t moleculeIndex, const int sign) {
+    MoleculeTypes moleculeType = moleculeStore.getMoleculeType(moleculeIndex);
+    assert(moleculeType >= 0 && size_t(moleculeType) < MOLECULE_TYPES_CNT);
+    assert(sign > 0 || moleculeTypeCnts[moleculeType] > 0);
+
+    double mass = moleculeStore.getMass(moleculeIndex);
+    gm_vector<double, 2> speedVector = moleculeStore.getSpeedVector(moleculeIndex);
+
+    moleculeTypeCnts[moleculeType] += sign;
+    totalMass += sign * mass;
+    doubledKineticEnergy += sign * mass * speedVector.get_len2();
+    momentumX += sign * mass * speedVector.get_x();
+    momentumY += sign * mass * speedVector.get_y();
+}
+
+size_t CoreObservables::getMoleculesCnt() const {
+    size_t moleculesCnt = 0;
+    for (size_t moleculeType = 0; moleculeType < MOLECULE_TYPES_CNT; moleculeType++)
+        moleculesCnt += moleculeTypeCnts[moleculeType];
+
+    return moleculesCnt;
+}
+
+void CoreObservables::addWallHit
+(
+    const WallType wallType, const int mass,
+    const gm_vector<double, 2> &speedVector, const gm_vector<double, 2> &newSpeedVector
+) {
+    assert(wallType != NONE_WALL);
+
+    double impulseX = mass * (newSpeedVector.get_x() - speedVector.get_x());
+    double impulseY = mass * (newSpeedVector.get_y() - speedVector.get_y());
+
+    momentumX += impulseX;
+    momentumY += impulseY;
+    doubledKineticEnergy += mass * (newSpeedVector.get_len2() - speedVector.get_len2());
+
+    // the wall takes what the molecule lost, its outward normal points away from the box
+    switch (wallType) {
+        case UPPER_WALL: stepWallImpulses[UPPER_WALL] += impulseY;  break;
+        case LEFT_WALL:  stepWallImpulses[LEFT_WALL] += impulseX;   break;
+        case LOWER_WALL: stepWallImpulses[LOWER_WALL] -= impulseY;  break;
+        case RIGHT_WALL: stepWallImpulses[RIGHT_WALL] -= impulseX;  break;
+        default: assert(0 && "unknown wallType");
+    }
+}
+
+void CoreObservables::addBoxWallImpulses(const BoxWallImpulses &boxWallImpulses, const double leftWallSpeed) {
+    momentumX += boxWallImpulses.leftWall - boxWallImpulses.rightWall;
+    momentumY += boxWallImpulses.lowWall - boxWallImpulses.highWall;
+
+    // in the frame of a wall moving at u a bounce is elastic, in the box frame it does u * impulse of work
+    doubledKineticEnergy += 2 * leftWallSpeed * boxWallImpulses.leftWall;
+
+    stepWallImpulses[LEFT_WALL] += boxWallImpulses.leftWall;
+    stepWallImpulses[RIGHT_WALL] += boxWallImpulses.rightWall;
+    stepWallImpulses[UPPER_WALL] += boxWallImpulses.lowWall;
+    stepWallImpulses[LOWER_WALL] += boxWallImpulses.highWall;
+}
+
+void CoreObservables::finishStep(const double deltaSecs, const double boxWidth, const double boxHeight) {
+    double wallLengths[WALLS_CNT] = {};
+    wallLengths[UPPER_WALL] = wallLengths[LOWER_WALL] = boxWidth;
+    wallLengths[LEFT_WALL] = wallLengths[RIGHT_WALL] = boxHeight;
+
+    double stepImpulse = 0;
+    for (size_t wall = 0; wall < WALLS_CNT; wall++) {
+        stepImpulse += stepWallImpulses[wall];
+        wallImpulses[wall] += stepWallImpulses[wall];
+    }
+
+    if (deltaSecs > 0) {
+        // plain mean until CORE_PRESSURE_AVERAGING_SECS have passed, then an exponential one
+        averagedSecs = std::min(averagedSecs + deltaSecs, CORE_PRESSURE_AVERAGING_SECS);
+        double stepWeight = deltaSecs / std::max(averagedSecs, deltaSecs);
+
+        double perimeter = 0;
+        for (size_t wall = 0; wall < WALLS_CNT; wall++) {
+            double stepPressure = (wallLengths[wall] > 0) ? stepWallImpulses[wall] / (deltaSecs * wallLengths[wall]) : 0;
+            wallPressures[wall] += stepWeight * (stepPressure - wallPressures[wall]);
+            perimeter += wallLengths[wall];
+        }
+
+        double stepPressure = (perimeter > 0) ? stepImpulse / (deltaSecs * perimeter) : 0;
+        pressure += stepWeight * (stepPressure - pressure);
+    }
+
+    std::fill(stepWallImpulses, stepWallImpulses + WALLS_CNT, 0);
+}
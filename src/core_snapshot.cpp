@@ -0,0 +1,181 @@
+#include "reactorcore.h"
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CORE_SNAPSHOT_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+bool ReactorCore::saveSnapshot(std::ostream &stream) const {
+    CoreSnapshotHeader header = {};
+    header.magic = CORE_SNAPSHOT_MAGIC;
+    header.version = CORE_SNAPSHOT_VERSION;
+    header.headerSize = sizeof(CoreSnapshotHeader);
+
+    header.seed = randomGenerator.getSeed();
+    header.randomDrawsCnt = randomDrawsCnt;
+    header.spawnedMoleculesCnt = spawnedMoleculesCnt;
+
+    header.currentTime = currentReactorCoreTime;
+    header.cordSysWidth = cordSysWidth;
+    header.cordSysHeight = cordSysHeight;
+    header.pistonPosition = pistonPosition;
+    header.pistonTargetPosition = pistonTargetPosition;
+    header.pistonSpeed = pistonSpeed;
+
+    header.collisionDetectionMode = collisionDetectionMode;
+    header.steppingMode = steppingMode;
+    header.moleculesCnt = moleculeStore.size();
+
+    // the layout is fully known before anything is written, so the header goes first
+    uint64_t offset = alignCoreSnapshotOffset(sizeof(CoreSnapshotHeader));
+    size_t arrayIndex = 0;
+    moleculeStore.forEachArray([&](const auto &array) {
+        typedef typename std::decay_t<decltype(array)>::value_type Element;
+
+        header.arrays[arrayIndex++] = {offset, array.size(), sizeof(Element)};
+        offset = alignCoreSnapshotOffset(offset + array.size() * sizeof(Element));
+    });
+    header.fileSize = offset;
+
+    static const char padding[CORE_SNAPSHOT_ALIGNMENT] = {};
+
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(CoreSnapshotHeader));
+    uint64_t writtenSize = sizeof(CoreSnapshotHeader);
+
+    arrayIndex = 0;
+    moleculeStore.forEachArray([&](const auto &array) {
+        const CoreSnapshotArray &arrayInfo = header.arrays[arrayIndex++];
+
+        stream.write(padding, arrayInfo.offset - writtenSize);
+        stream.write(reinterpret_cast<const char *>(array.data()), arrayInfo.length * arrayInfo.elementSize);
+        writtenSize = arrayInfo.offset + arrayInfo.length * arrayInfo.elementSize;
+    });
+    stream.write(padding, header.fileSize - writtenSize);
+
+    return bool(stream);
+}
+
+bool ReactorCore::saveSnapshot(const std::string &path) const {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream || !saveSnapshot(stream)) return false;
+
+    stream.close();
+    return !stream.fail();
+}
+
+
+static bool isCoreSnapshotHeaderValid(const CoreSnapshotHeader &header, const size_t size) {
+    if (header.magic != CORE_SNAPSHOT_MAGIC || header.version != CORE_SNAPSHOT_VERSION) return false;
+    if (header.headerSize != sizeof(CoreSnapshotHeader) || header.fileSize > size) return false;
+
+    if (header.collisionDetectionMode >= COLLISION_DETECTION_MODES_CNT) return false;
+    if (header.steppingMode >= STEPPING_MODES_CNT) return false;
+    if (!(header.cordSysWidth >= 0 && header.cordSysHeight >= 0)) return false;
+
+    for (size_t arrayIndex = 0; arrayIndex < MOLECULE_STORE_ARRAYS_CNT; arrayIndex++) {
+        const CoreSnapshotArray &arrayInfo = header.arrays[arrayIndex];
+
+        if (arrayIndex < MOLECULE_STORE_PER_MOLECULE_ARRAYS_CNT && arrayInfo.length != header.moleculesCnt) return false;
+        if (arrayInfo.offset % CORE_SNAPSHOT_ALIGNMENT != 0 || arrayInfo.offset > header.fileSize) return false;
+        if (arrayInfo.elementSize == 0 || arrayInfo.length > (header.fileSize - arrayInfo.offset) / arrayInfo.elementSize) return false;
+    }
+
+    return true;
+}
+
+bool ReactorCore::loadSnapshot(const void *data, const size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    if (size < sizeof(CoreSnapshotHeader)) return false;
+
+    CoreSnapshotHeader header;
+    std::memcpy(&header, bytes, sizeof(CoreSnapshotHeader));
+    if (!isCoreSnapshotHeaderValid(header, size)) return false;
+
+    // element sizes are what tells a stale layout apart when the version was not bumped
+    bool isLayoutValid = true;
+    size_t arrayIndex = 0;
+    moleculeStore.forEachArray([&](const auto &array) {
+        typedef typename std::decay_t<decltype(array)>::value_type Element;
+        isLayoutValid &= header.arrays[arrayIndex++].elementSize == sizeof(Element);
+    });
+    if (!isLayoutValid) return false;
+
+    // No parsing: every array is one bulk copy out of the mapped file. The copies land in a scratch
+    // store, which replaces the core's one only after its contents are checked too.
+    MoleculeStore loadedMoleculeStore;
+    arrayIndex = 0;
+    loadedMoleculeStore.forEachArray([&](auto &array) {
+        const CoreSnapshotArray &arrayInfo = header.arrays[arrayIndex++];
+
+        array.resize(arrayInfo.length);
+        if (arrayInfo.length > 0)
+            std::memcpy(array.data(), bytes + arrayInfo.offset, arrayInfo.length * arrayInfo.elementSize);
+    });
+    if (!loadedMoleculeStore.isConsistent()) return false;
+
+    moleculeStore = std::move(loadedMoleculeStore);
+
+    randomGenerator.setSeed(header.seed);
+    randomDrawsCnt = header.randomDrawsCnt;
+    spawnedMoleculesCnt = header.spawnedMoleculesCnt;
+
+    currentReactorCoreTime = header.currentTime;
+    closestEventTimePoint = std::numeric_limits<double>::quiet_NaN();
+
+    collisionDetectionMode = CollisionDetectionMode(header.collisionDetectionMode);
+    steppingMode = SteppingMode(header.steppingMode);
+
+    setCoreSize(header.cordSysWidth, header.cordSysHeight);
+    pistonTargetPosition = header.pistonTargetPosition;
+    pistonSpeed = header.pistonSpeed;
+    setPistonWall(header.pistonPosition);
+
+    observables.recount(moleculeStore);
+    return true;
+}
+
+bool ReactorCore::loadSnapshot(const std::string &path) {
+#ifdef CORE_SNAPSHOT_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t fileSize = size_t(fileStat.st_size);
+    int mapFlags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    // the whole file is read right away, faulting it in up front beats one fault per page
+    mapFlags |= MAP_POPULATE;
+#endif
+
+    void *data = mmap(nullptr, fileSize, PROT_READ, mapFlags, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    bool isLoaded = loadSnapshot(data, fileSize);
+    munmap(data, fileSize);
+    return isLoaded;
+#else
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) return false;
+
+    std::vector<char> data(size_t(stream.tellg()));
+    stream.seekg(0);
+    if (!stream.read(data.data(), data.size())) return false;
+
+    return loadSnapshot(data.data(), data.size());
+#endif
+}
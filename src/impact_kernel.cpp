@@ -0,0 +1,186 @@
+#include "impact_kernel.h"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#ifdef SIMD_ISA_X86
+#include <immintrin.h>
+#endif
+
+// Every kernel evaluates the same expressions in the same order without fused multiply-adds
+// (the file is built with -ffp-contract=off), so lanes match the scalar path bit for bit:
+//   a = V.V,  b = 2 (P.V),  c = P.P - r^2,  D = b^2 - 4ac,  t = (-b - sqrt(D)) / 2a
+
+
+static uint64_t computeImpactDeltasScalar
+(
+    const double x, const double y, const double speedX, const double speedY, const double collideRadius,
+    const double *xs, const double *ys, const double *speedXs, const double *speedYs, const double *collideRadiuses,
+    const size_t firstCandidate, const size_t candidatesCnt, const double maxDelta, double *impactDeltas
+) {
+    uint64_t hitsMask = 0;
+
+    for (size_t i = firstCandidate; i < candidatesCnt; i++) {
+        double px = x - xs[i];
+        double py = y - ys[i];
+        double vx = speedX - speedXs[i];
+        double vy = speedY - speedYs[i];
+        double radius = collideRadius + collideRadiuses[i];
+
+        double aCoef = vx * vx + vy * vy;
+        double bCoef = 2 * (px * vx + py * vy);
+        double cCoef = px * px + py * py - radius * radius;
+        double discriminant = bCoef * bCoef - 4 * aCoef * cCoef;
+
+        impactDeltas[i] = std::numeric_limits<double>::quiet_NaN();
+        if (aCoef == 0 || !(discriminant >= 0)) continue;
+
+        double delta = (-bCoef - std::sqrt(discriminant)) / (2 * aCoef);
+        if (!(delta >= 0)) continue;
+
+        impactDeltas[i] = delta;
+        if (delta <= maxDelta) hitsMask |= uint64_t(1) << i;
+    }
+
+    return hitsMask;
+}
+
+#ifdef SIMD_ISA_X86
+
+__attribute__((target("avx2")))
+static uint64_t computeImpactDeltasAvx2
+(
+    const double x, const double y, const double speedX, const double speedY, const double collideRadius,
+    const double *xs, const double *ys, const double *speedXs, const double *speedYs, const double *collideRadiuses,
+    const size_t candidatesCnt, const double maxDelta, double *impactDeltas
+) {
+    static const size_t LANES_CNT = 4;
+
+    const __m256d xVec = _mm256_set1_pd(x);
+    const __m256d yVec = _mm256_set1_pd(y);
+    const __m256d speedXVec = _mm256_set1_pd(speedX);
+    const __m256d speedYVec = _mm256_set1_pd(speedY);
+    const __m256d collideRadiusVec = _mm256_set1_pd(collideRadius);
+    const __m256d maxDeltaVec = _mm256_set1_pd(maxDelta);
+    const __m256d zeroVec = _mm256_setzero_pd();
+    const __m256d twoVec = _mm256_set1_pd(2);
+    const __m256d fourVec = _mm256_set1_pd(4);
+    const __m256d signMaskVec = _mm256_set1_pd(-0.0);
+    const __m256d nanVec = _mm256_set1_pd(std::numeric_limits<double>::quiet_NaN());
+
+    uint64_t hitsMask = 0;
+    size_t i = 0;
+
+    for (; i + LANES_CNT <= candidatesCnt; i += LANES_CNT) {
+        __m256d px = _mm256_sub_pd(xVec, _mm256_loadu_pd(xs + i));
+        __m256d py = _mm256_sub_pd(yVec, _mm256_loadu_pd(ys + i));
+        __m256d vx = _mm256_sub_pd(speedXVec, _mm256_loadu_pd(speedXs + i));
+        __m256d vy = _mm256_sub_pd(speedYVec, _mm256_loadu_pd(speedYs + i));
+        __m256d radius = _mm256_add_pd(collideRadiusVec, _mm256_loadu_pd(collideRadiuses + i));
+
+        __m256d aCoef = _mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy));
+        __m256d bCoef = _mm256_mul_pd(twoVec, _mm256_add_pd(_mm256_mul_pd(px, vx), _mm256_mul_pd(py, vy)));
+        __m256d cCoef = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(px, px), _mm256_mul_pd(py, py)), _mm256_mul_pd(radius, radius));
+        __m256d discriminant = _mm256_sub_pd(_mm256_mul_pd(bCoef, bCoef), _mm256_mul_pd(_mm256_mul_pd(fourVec, aCoef), cCoef));
+
+        __m256d delta = _mm256_div_pd(_mm256_sub_pd(_mm256_xor_pd(bCoef, signMaskVec), _mm256_sqrt_pd(discriminant)),
+                                      _mm256_mul_pd(twoVec, aCoef));
+
+        __m256d isValid = _mm256_and_pd(_mm256_cmp_pd(aCoef, zeroVec, _CMP_NEQ_OQ),
+                          _mm256_and_pd(_mm256_cmp_pd(discriminant, zeroVec, _CMP_GE_OQ),
+                                        _mm256_cmp_pd(delta, zeroVec, _CMP_GE_OQ)));
+        __m256d isHit = _mm256_and_pd(isValid, _mm256_cmp_pd(delta, maxDeltaVec, _CMP_LE_OQ));
+
+        _mm256_storeu_pd(impactDeltas + i, _mm256_blendv_pd(nanVec, delta, isValid));
+        hitsMask |= uint64_t(_mm256_movemask_pd(isHit)) << i;
+    }
+
+    return hitsMask | computeImpactDeltasScalar(x, y, speedX, speedY, collideRadius, xs, ys, speedXs, speedYs, collideRadiuses,
+                                                /*firstCandidate=*/i, candidatesCnt, maxDelta, impactDeltas);
+}
+
+__attribute__((target("avx512f")))
+static uint64_t computeImpactDeltasAvx512
+(
+    const double x, const double y, const double speedX, const double speedY, const double collideRadius,
+    const double *xs, const double *ys, const double *speedXs, const double *speedYs, const double *collideRadiuses,
+    const size_t candidatesCnt, const double maxDelta, double *impactDeltas
+) {
+    static const size_t LANES_CNT = 8;
+
+    const __m512d xVec = _mm512_set1_pd(x);
+    const __m512d yVec = _mm512_set1_pd(y);
+    const __m512d speedXVec = _mm512_set1_pd(speedX);
+    const __m512d speedYVec = _mm512_set1_pd(speedY);
+    const __m512d collideRadiusVec = _mm512_set1_pd(collideRadius);
+    const __m512d maxDeltaVec = _mm512_set1_pd(maxDelta);
+    const __m512d zeroVec = _mm512_setzero_pd();
+    const __m512d twoVec = _mm512_set1_pd(2);
+    const __m512d fourVec = _mm512_set1_pd(4);
+    const __m512i signMaskVec = _mm512_set1_epi64(std::numeric_limits<int64_t>::min());
+    const __m512d nanVec = _mm512_set1_pd(std::numeric_limits<double>::quiet_NaN());
+
+    uint64_t hitsMask = 0;
+
+    // the tail goes through masked loads, lanes past candidatesCnt are never stored
+    for (size_t i = 0; i < candidatesCnt; i += LANES_CNT) {
+        size_t lanesCnt = (candidatesCnt - i < LANES_CNT) ? candidatesCnt - i : LANES_CNT;
+        __mmask8 lanesMask = __mmask8((1u << lanesCnt) - 1);
+
+        __m512d px = _mm512_sub_pd(xVec, _mm512_maskz_loadu_pd(lanesMask, xs + i));
+        __m512d py = _mm512_sub_pd(yVec, _mm512_maskz_loadu_pd(lanesMask, ys + i));
+        __m512d vx = _mm512_sub_pd(speedXVec, _mm512_maskz_loadu_pd(lanesMask, speedXs + i));
+        __m512d vy = _mm512_sub_pd(speedYVec, _mm512_maskz_loadu_pd(lanesMask, speedYs + i));
+        __m512d radius = _mm512_add_pd(collideRadiusVec, _mm512_maskz_loadu_pd(lanesMask, collideRadiuses + i));
+
+        __m512d aCoef = _mm512_add_pd(_mm512_mul_pd(vx, vx), _mm512_mul_pd(vy, vy));
+        __m512d bCoef = _mm512_mul_pd(twoVec, _mm512_add_pd(_mm512_mul_pd(px, vx), _mm512_mul_pd(py, vy)));
+        __m512d cCoef = _mm512_sub_pd(_mm512_add_pd(_mm512_mul_pd(px, px), _mm512_mul_pd(py, py)), _mm512_mul_pd(radius, radius));
+        __m512d discriminant = _mm512_sub_pd(_mm512_mul_pd(bCoef, bCoef), _mm512_mul_pd(_mm512_mul_pd(fourVec, aCoef), cCoef));
+
+        __m512d negBCoef = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(bCoef), signMaskVec));
+        __m512d delta = _mm512_div_pd(_mm512_sub_pd(negBCoef, _mm512_sqrt_pd(discriminant)), _mm512_mul_pd(twoVec, aCoef));
+
+        __mmask8 isValid = _mm512_mask_cmp_pd_mask(lanesMask, aCoef, zeroVec, _CMP_NEQ_OQ);
+        isValid = _mm512_mask_cmp_pd_mask(isValid, discriminant, zeroVec, _CMP_GE_OQ);
+        isValid = _mm512_mask_cmp_pd_mask(isValid, delta, zeroVec, _CMP_GE_OQ);
+        __mmask8 isHit = _mm512_mask_cmp_pd_mask(isValid, delta, maxDeltaVec, _CMP_LE_OQ);
+
+        _mm512_mask_storeu_pd(impactDeltas + i, lanesMask, _mm512_mask_blend_pd(isValid, nanVec, delta));
+        hitsMask |= uint64_t(isHit) << i;
+    }
+
+    return hitsMask;
+}
+
+#endif // SIMD_ISA_X86
+
+
+uint64_t computeImpactDeltas
+(
+    const double x, const double y, const double speedX, const double speedY, const double collideRadius,
+    const double *xs, const double *ys, const double *speedXs, const double *speedYs, const double *collideRadiuses,
+    const size_t candidatesCnt, const double maxDelta, double *impactDeltas,
+    const SimdIsa isa
+) {
+    assert(candidatesCnt <= IMPACT_BATCH_MAX_SIZE);
+    assert(isSimdIsaSupported(isa));
+
+    switch (isa) {
+#ifdef SIMD_ISA_X86
+        case AVX512_SIMD_ISA:
+            return computeImpactDeltasAvx512(x, y, speedX, speedY, collideRadius, xs, ys, speedXs, speedYs, collideRadiuses,
+                                             candidatesCnt, maxDelta, impactDeltas);
+        case AVX2_SIMD_ISA:
+            return computeImpactDeltasAvx2(x, y, speedX, speedY, collideRadius, xs, ys, speedXs, speedYs, collideRadiuses,
+                                           candidatesCnt, maxDelta, impactDeltas);
+#endif
+        case SCALAR_SIMD_ISA:
+            return computeImpactDeltasScalar(x, y, speedX, speedY, collideRadius, xs, ys, speedXs, speedYs, collideRadiuses,
+                                             /*firstCandidate=*/0, candidatesCnt, maxDelta, impactDeltas);
+        default:
+            assert(0 && "unknown SimdIsa");
+            return 0;
+    }
+}
@@ -0,0 +1,53 @@
+#include "molecule_reactions.h"
+
+#include <cmath>
+#include <numbers>
+
+
+void QuadritQuadritReaction(
+    MoleculeStore &moleculeStore,
+    const size_t fstMoleculeIndex,
+    const size_t sndMoleculeIndex
+) {
+    gm_vector<double, 2> fstMoleculePosition = moleculeStore.getPosition(fstMoleculeIndex);
+    gm_vector<double, 2> collideCenter = fstMoleculePosition + (fstMoleculePosition - fstMoleculePosition) * 0.5;
+
+    int boomMoleculeCnt = moleculeStore.getMass(fstMoleculeIndex) + moleculeStore.getMass(fstMoleculeIndex);
+    
+    
+
+    double boomRootationAngle = 2 * std::numbers::pi / boomMoleculeCnt;
+    
+    double boomRadius = std::sqrt(2 / std::sin(boomRootationAngle)) * Circlit::getSize(1) * 2;
+    gm_vector<double, 2> boomCurSpeedVector = gm_vector<double, 2>(0, -1) * boomRadius;
+
+    moleculeStore.setPhysicalState(fstMoleculeIndex, DEATH);
+    moleculeStore.setPhysicalState(sndMoleculeIndex, DEATH);
+    for (int i = 0; i < boomMoleculeCnt; i++) {
+        moleculeStore.addMolecule(CIRCLIT, collideCenter + boomCurSpeedVector, boomCurSpeedVector, 1, UNRESPONSIVE);
+        boomCurSpeedVector = boomCurSpeedVector.rotate(boomRootationAngle);
+    }
+}
+
+void CirclitQuadritReaction(
+    MoleculeStore &moleculeStore,
+    const size_t fstMoleculeIndex,
+    const size_t sndMoleculeIndex
+) {
+    gm_vector<double, 2> fstMoleculePosition = moleculeStore.getPosition(fstMoleculeIndex);
+    gm_vector<double, 2> collideCenter = fstMoleculePosition + (fstMoleculePosition - fstMoleculePosition) * 0.5;
+
+    int fstMoleculeMass = moleculeStore.getMass(fstMoleculeIndex);
+    int sndMoleculeMass = moleculeStore.getMass(sndMoleculeIndex);
+    int newMass = fstMoleculeMass + sndMoleculeMass;
+   
+    
+    gm_vector<double, 2> newspeedVector = (moleculeStore.getSpeedVector(fstMoleculeIndex) * fstMoleculeMass + 
+                                          moleculeStore.getSpeedVector(sndMoleculeIndex) * sndMoleculeMass) * (1.0 / newMass);
+
+    
+    moleculeStore.setPhysicalState(fstMoleculeIndex, DEATH);
+    moleculeStore.setPhysicalState(sndMoleculeIndex, DEATH);
+
+    moleculeStore.addMolecule(QUADRIT, collideCenter, newspeedVector, newMass, UNRESPONSIVE);
+}
@@ -60,7 +60,8 @@ void Reactor::setPistonPercentage(const int value) {
     updateInternalRectanglesInfo();
 
     reactorCanvas->setInternalRectangles(pistonRectangle, coreRectangle);
-    reactorCore->setCoreRectangle(coreRectangle);
+    reactorCore->setCoreRectangle(pistonRectangle.united(coreRectangle));
+    reactorCore->setPistonRectangle(pistonRectangle);
 
     emit pistonPercentageChanged(value);
 }
\ No newline at end of file
@@ -1,80 +1,712 @@
 #include "reactorcore.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 
+void ReactorCore::processCollisionsBruteForce() {
+    // molecules born in reactions are appended to the store tail, they are skipped until the next tick
+    size_t moleculesCnt = moleculeStore.size();
 
-void QuadritQuadritReaction(
-    std::list<std::unique_ptr<Molecule>> &moleculeList,
-    std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-    std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT
-) {
-    Molecule *fstMoleculePTR = (*fstMoleculeIT).get();
-    Molecule *sndMoleculePTR = (*sndMoleculeIT).get();
+    for (size_t fst = 0; fst < moleculesCnt; fst++) {
+        for (size_t snd = fst + 1; snd < moleculesCnt; snd++)
+            processMoleculeCollision(fst, snd);
+    }
+}
+
+void ReactorCore::processCollisionsUniformGrid() {
+    size_t moleculesCnt = moleculeStore.size();
+    if (moleculesCnt < 2) return;
+
+    const double *collideRadiuses = moleculeStore.getCollideRadiuses();
+    double maxCollideCircleRadius = *std::max_element(collideRadiuses, collideRadiuses + moleculesCnt);
+
+    // processMoleculeCollision reacts when distance^2 < (r1 + r2)^2 + DISTANCE_COLLISION_EPS2
+    double maxCollisionDistance = 2 * maxCollideCircleRadius;
+    double gridCellSize = std::sqrt(maxCollisionDistance * maxCollisionDistance + DISTANCE_COLLISION_EPS2) + DISTANCE_COLLISION_EPS;
+
+    spatialGrid.rebuild(moleculeStore.getXs(), moleculeStore.getYs(), moleculesCnt,
+                        gridCellSize, pistonPosition, cordSysWidth - pistonPosition, cordSysHeight);
+
+    tickCandidatePairs.clear();
+    spatialGrid.forEachCandidatePair([this](const size_t fst, const size_t snd) {
+        tickCandidatePairs.emplace_back(std::min(fst, snd), std::max(fst, snd));
+    });
+
+    std::sort(tickCandidatePairs.begin(), tickCandidatePairs.end());
+
+    for (const auto &[fst, snd] : tickCandidatePairs)
+        processMoleculeCollision(fst, snd);
+}
+
+
+void ReactorCore::processCollisionsUniformGridParallel() {
+    size_t moleculesCnt = moleculeStore.size();
+    if (moleculesCnt < 2) return;
+
+    const double *collideRadiuses = moleculeStore.getCollideRadiuses();
+    double maxCollideCircleRadius = *std::max_element(collideRadiuses, collideRadiuses + moleculesCnt);
+
+    double maxCollisionDistance = 2 * maxCollideCircleRadius;
+    double gridCellSize = std::sqrt(maxCollisionDistance * maxCollisionDistance + DISTANCE_COLLISION_EPS2) + DISTANCE_COLLISION_EPS;
+
+    spatialGrid.rebuild(moleculeStore.getXs(), moleculeStore.getYs(), moleculesCnt,
+                        gridCellSize, pistonPosition, cordSysWidth - pistonPosition, cordSysHeight);
+
+    // search phase: positions are read only, every partition of cells collects its pairs in contact
+    size_t cellsCnt = spatialGrid.getCellsCnt();
+    size_t partitionsCnt = std::min(cellsCnt, workerPool->getThreadsCnt() * WORKER_POOL_CHUNKS_PER_THREAD);
+    size_t partitionCellsCnt = (cellsCnt + partitionsCnt - 1) / partitionsCnt;
+
+    partitionContactPairs.resize(partitionsCnt);
+    workerPool->parallelForChunks(partitionsCnt, [&](const size_t partition) {
+        std::vector<std::pair<size_t, size_t>> &contactPairs = partitionContactPairs[partition];
+        contactPairs.clear();
+
+        size_t cellBegin = std::min(cellsCnt, partition * partitionCellsCnt);
+        size_t cellEnd = std::min(cellsCnt, cellBegin + partitionCellsCnt);
+        spatialGrid.forEachCandidatePairInCells(cellBegin, cellEnd, [&](const size_t fst, const size_t snd) {
+            if (isMoleculesInContact(fst, snd))
+                contactPairs.emplace_back(std::min(fst, snd), std::max(fst, snd));
+        });
+    });
+
+    // commit phase: reactions run serially in the same order as processCollisionsUniformGrid
+    tickCandidatePairs.clear();
+    for (size_t partition = 0; partition < partitionsCnt; partition++)
+        tickCandidatePairs.insert(tickCandidatePairs.end(), partitionContactPairs[partition].begin(), partitionContactPairs[partition].end());
+
+    std::sort(tickCandidatePairs.begin(), tickCandidatePairs.end());
+
+    for (const auto &[fst, snd] : tickCandidatePairs)
+        processMoleculeCollision(fst, snd);
+}
+
+void ReactorCore::processCollisionsSweepAndPrune() {
+    size_t moleculesCnt = moleculeStore.size();
+    if (moleculesCnt < 2) return;
+
+    // processMoleculeCollision reacts when distance < sqrt((r1 + r2)^2 + DISTANCE_COLLISION_EPS2),
+    // which is below r1 + r2 + DISTANCE_COLLISION_EPS: each molecule brings half of the eps
+    sweepAndPrune.update(moleculeStore.getXs(), moleculeStore.getYs(), moleculeStore.getCollideRadiuses(),
+                         moleculeStore.getHandles(), moleculesCnt, /*margin=*/DISTANCE_COLLISION_EPS / 2);
+
+    tickCandidatePairs.clear();
+    sweepAndPrune.forEachCandidatePair([this](const size_t fst, const size_t snd) {
+        tickCandidatePairs.emplace_back(std::min(fst, snd), std::max(fst, snd));
+    });
+
+    std::sort(tickCandidatePairs.begin(), tickCandidatePairs.end());
+
+    for (const auto &[fst, snd] : tickCandidatePairs)
+        processMoleculeCollision(fst, snd);
+}
+
+void ReactorCore::processCollisionsAabbTree(const double deltaSecs) {
+    size_t moleculesCnt = moleculeStore.size();
+
+    // runs on one molecule too: the tree has to drop the leaves of the molecules that died
+    aabbTree.update(moleculeStore.getXs(), moleculeStore.getYs(), moleculeStore.getSpeedXs(), moleculeStore.getSpeedYs(),
+                    moleculeStore.getCollideRadiuses(), moleculeStore.getHandles(), moleculesCnt,
+                    /*margin=*/DISTANCE_COLLISION_EPS / 2, deltaSecs);
+
+    tickCandidatePairs.clear();
+    aabbTree.forEachCandidatePair([this](const size_t fst, const size_t snd) {
+        tickCandidatePairs.emplace_back(std::min(fst, snd), std::max(fst, snd));
+    });
+
+    std::sort(tickCandidatePairs.begin(), tickCandidatePairs.end());
+
+    for (const auto &[fst, snd] : tickCandidatePairs)
+        processMoleculeCollision(fst, snd);
+}
+
+void ReactorCore::sweepMoleculesBehindPiston() {
+    double *xs = moleculeStore.getXs();
+    double *speedXs = moleculeStore.getSpeedXs();
+
+    for (size_t moleculeIndex = 0; moleculeIndex < moleculeStore.size(); moleculeIndex++) {
+        if (!(xs[moleculeIndex] < pistonPosition)) continue;
+
+        xs[moleculeIndex] = pistonPosition;
+        if (speedXs[moleculeIndex] < pistonSpeed) {
+            gm_vector<double, 2> speedVector = moleculeStore.getSpeedVector(moleculeIndex);
+            speedXs[moleculeIndex] = 2 * pistonSpeed - speedXs[moleculeIndex];
+
+            observables.addWallHit(LEFT_WALL, moleculeStore.getMass(moleculeIndex), speedVector, moleculeStore.getSpeedVector(moleculeIndex));
+        }
+    }
+}
+
+void ReactorCore::fixedStepUpdate(const double deltaSecs) {
+    double *xs = moleculeStore.getXs();
+    double *ys = moleculeStore.getYs();
+    double *speedXs = moleculeStore.getSpeedXs();
+    double *speedYs = moleculeStore.getSpeedYs();
+    const int *masses = moleculeStore.getMasses();
+    size_t moleculesCnt = moleculeStore.size();
 
-    gm_vector<double, 2> collideCenter = fstMoleculePTR->getPosition() + (fstMoleculePTR->getPosition() - fstMoleculePTR->getPosition()) * 0.5;
+    // The piston has already moved: the kernel reflects off it at its new position with its speed,
+    // which also pushes out molecules it swept over. An empty box (canvas not laid out) freezes molecules.
+    if (!isCoreBoxEmpty()) {
+        // Molecules go in chunks of a fixed size whatever the threads count, and the wall impulses
+        // of the chunks are added up in chunk order, so observables do not depend on threads either.
+        size_t chunksCnt = (moleculesCnt + BOX_IMPULSE_CHUNK_MOLECULES_CNT - 1) / BOX_IMPULSE_CHUNK_MOLECULES_CNT;
+        chunkWallImpulses.assign(chunksCnt, BoxWallImpulses());
 
-    int boomMoleculeCnt = fstMoleculePTR->getMass() + fstMoleculePTR->getMass();
-    
-    
+        auto integrateChunk = [=, this](const size_t chunk) {
+            size_t begin = chunk * BOX_IMPULSE_CHUNK_MOLECULES_CNT;
+            size_t end = std::min(moleculesCnt, begin + BOX_IMPULSE_CHUNK_MOLECULES_CNT);
 
-    double boomRootationAngle = 2 * std::numbers::pi / boomMoleculeCnt;
-    
-    double boomRadius = std::sqrt(2 / std::sin(boomRootationAngle)) * Circlit({0, 0}, {0, 0}, 1).getSize() * 2;
-    gm_vector<double, 2> boomCurSpeedVector = gm_vector<double, 2>(0, -1) * boomRadius;
+            integrateBoxMovement(xs + begin, ys + begin, speedXs + begin, speedYs + begin, masses + begin, end - begin,
+                                 pistonPosition, cordSysWidth, cordSysHeight, pistonSpeed, deltaSecs,
+                                 chunkWallImpulses[chunk]);
+        };
 
-    fstMoleculePTR->sePhysicalState(DEATH);
-    sndMoleculePTR->sePhysicalState(DEATH);
-    for (int i = 0; i < boomMoleculeCnt; i++) {
-        moleculeList.push_back(std::make_unique<Circlit>(collideCenter + boomCurSpeedVector, boomCurSpeedVector, 1));
-        boomCurSpeedVector = boomCurSpeedVector.rotate(boomRootationAngle);
-        (*(std::prev(moleculeList.end()))).get()->sePhysicalState(UNRESPONSIVE);        
+        if (workerPool) {
+            workerPool->parallelForChunks(chunksCnt, integrateChunk);
+        } else {
+            for (size_t chunk = 0; chunk < chunksCnt; chunk++)
+                integrateChunk(chunk);
+        }
+
+        BoxWallImpulses wallImpulses;
+        for (const BoxWallImpulses &chunkImpulses : chunkWallImpulses) {
+            wallImpulses.leftWall += chunkImpulses.leftWall;
+            wallImpulses.rightWall += chunkImpulses.rightWall;
+            wallImpulses.lowWall += chunkImpulses.lowWall;
+            wallImpulses.highWall += chunkImpulses.highWall;
+        }
+
+        observables.addBoxWallImpulses(wallImpulses, pistonSpeed);
+    }
+
+    // all detection modes handle candidate pairs in the same (fst, snd) index order,
+    // so reactions happen identically and the modes can be compared against each other
+    switch (collisionDetectionMode) {
+        case BRUTE_FORCE_DETECTION:
+            processCollisionsBruteForce();
+            break;
+        case UNIFORM_GRID_DETECTION:
+            if (workerPool) processCollisionsUniformGridParallel();
+            else            processCollisionsUniformGrid();
+            break;
+        case SWEEP_AND_PRUNE_DETECTION:
+            processCollisionsSweepAndPrune();
+            break;
+        case AABB_TREE_DETECTION:
+            processCollisionsAabbTree(deltaSecs);
+            break;
+        default: assert(0 && "unknown collisionDetectionMode");
     }
 }
 
-void CirclitQuadritReaction(
-    std::list<std::unique_ptr<Molecule>> &moleculeList,
-    std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-    std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT
-) {
-    Molecule *fstMoleculePTR = (*fstMoleculeIT).get();
-    Molecule *sndMoleculePTR = (*sndMoleculeIT).get();
+void ReactorCore::updateAdaptiveStepStats(const double deltaSecs) {
+    size_t moleculesCnt = moleculeStore.size();
+    const double *speedXs = moleculeStore.getSpeedXs();
+    const double *speedYs = moleculeStore.getSpeedYs();
+    const double *collideRadiuses = moleculeStore.getCollideRadiuses();
+
+    // dead molecules awaiting compaction are frozen with no collide radius, only the piston moves them
+    double maxSpeed2 = 0;
+    double minCollideRadius = std::numeric_limits<double>::infinity();
+    size_t liveMoleculesCnt = 0;
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        bool isFrozen = collideRadiuses[i] == 0;
+        maxSpeed2 = std::max(maxSpeed2, isFrozen ? 0 : speedXs[i] * speedXs[i] + speedYs[i] * speedYs[i]);
+        minCollideRadius = std::min(minCollideRadius, isFrozen ? std::numeric_limits<double>::infinity() : collideRadiuses[i]);
+        liveMoleculesCnt += !isFrozen;
+    }
 
-    gm_vector<double, 2> collideCenter = fstMoleculePTR->getPosition() + (fstMoleculePTR->getPosition() - fstMoleculePTR->getPosition()) * 0.5;
+    AdaptiveStepStats &stats = adaptiveStepStats;
+    double boxArea = isCoreBoxEmpty() ? 0 : (cordSysWidth - pistonPosition) * cordSysHeight;
 
-    int newMass = fstMoleculePTR->getMass() + sndMoleculePTR->getMass();
-   
-    
-    gm_vector<double, 2> newspeedVector = (fstMoleculePTR->getSpeedVector() * fstMoleculePTR->getMass() + 
-                                          sndMoleculePTR->getSpeedVector() * sndMoleculePTR->getMass()) * (1.0 / newMass);
+    stats.maxSpeed = std::sqrt(maxSpeed2);
+    stats.minCollideRadius = (liveMoleculesCnt > 0) ? minCollideRadius : 0;
+    stats.density = (boxArea > 0) ? liveMoleculesCnt / boxArea : 0;
 
-    
-    fstMoleculePTR->sePhysicalState(DEATH);
-    sndMoleculePTR->sePhysicalState(DEATH);
+    // a molecule meets every centre closer than one collide distance to its path:
+    // the swept strip is 2 * (2 r) wide, giving the mean free path 1 / (density * 4 r)
+    double meanFreePath = std::numeric_limits<double>::infinity();
+    if (stats.density > 0 && stats.minCollideRadius > 0)
+        meanFreePath = 1 / (stats.density * 4 * stats.minCollideRadius);
 
-    moleculeList.push_back(std::make_unique<Quadrit>(collideCenter, newspeedVector, newMass));
-    (*(std::prev(moleculeList.end()))).get()->sePhysicalState(UNRESPONSIVE);        
+    stats.cflStepSecs = std::numeric_limits<double>::infinity();
+    stats.freePathStepSecs = std::numeric_limits<double>::infinity();
+    if (stats.maxSpeed > 0) {
+        stats.cflStepSecs = ADAPTIVE_STEP_CFL * stats.minCollideRadius / stats.maxSpeed;
+        stats.freePathStepSecs = ADAPTIVE_STEP_FREE_PATH_SHARE * meanFreePath / stats.maxSpeed;
+    }
+
+    double boundStepSecs = std::min(stats.cflStepSecs, stats.freePathStepSecs);
+    double wantedSubstepsCnt = (boundStepSecs > 0) ? std::ceil(deltaSecs / boundStepSecs) : std::numeric_limits<double>::infinity();
+
+    stats.isSubstepsCapped = wantedSubstepsCnt > ADAPTIVE_STEP_MAX_SUBSTEPS_CNT;
+    stats.substepsCnt = stats.isSubstepsCapped ? ADAPTIVE_STEP_MAX_SUBSTEPS_CNT : std::max<size_t>(size_t(wantedSubstepsCnt), 1);
+    stats.substepSecs = deltaSecs / stats.substepsCnt;
 }
 
+// Bounds are computed once per step() from the state at its start: reactions within the step can
+// speed molecules up, which the next step() accounts for.
+void ReactorCore::adaptiveStepUpdate(const double deltaSecs) {
+    updateAdaptiveStepStats(deltaSecs);
 
+    for (size_t substepIndex = 0; substepIndex < adaptiveStepStats.substepsCnt; substepIndex++) {
+        advancePiston(adaptiveStepStats.substepSecs);
+        fixedStepUpdate(adaptiveStepStats.substepSecs);
 
-void launchMoleculeReaction (
-    std::list<std::unique_ptr<Molecule>> &moleculeList,
-    std::list<std::unique_ptr<Molecule>>::iterator fstMoleculeIT,
-    std::list<std::unique_ptr<Molecule>>::iterator sndMoleculeIT 
-) {
-    MoleculeTypes fstMoleculeType = (*fstMoleculeIT).get()->moleculeType;
-    MoleculeTypes sndMoleculeType = (*sndMoleculeIT).get()->moleculeType;
+        // molecules killed by a reaction are frozen and skipped by collisions, compaction can wait;
+        // products must wake up for the following sub-steps though
+        if (substepIndex + 1 < adaptiveStepStats.substepsCnt)
+            removeDeadMolecules();
+    }
+}
 
+void ReactorCore::eventDrivenUpdate(const double deltaSecs) {
+    double startTimePoint = currentReactorCoreTime;
+    double endTimePoint = currentReactorCoreTime + deltaSecs;
+    size_t moleculesCnt = moleculeStore.size();
 
-    moleculeReaction reactionFunc = moleculeReactionsVTable[fstMoleculeType][sndMoleculeType];
+    sweepMoleculesBehindPiston();
 
-    if (reactionFunc == NULL) {
-        std::cout << "Unknown Reaction : " << fstMoleculeType << " + " << sndMoleculeType << "\n";
-        assert(0);
-        return;
+    moleculeTimePoints.assign(moleculesCnt, startTimePoint);
+    moleculeEventsCnts.assign(moleculesCnt, 0);
+    coreEventsHeap.clear();
+
+    buildEventNeighbours(deltaSecs);
+
+    for (size_t moleculeIndex = 0; moleculeIndex < moleculesCnt; moleculeIndex++) {
+        if (moleculeStore.getPhysicalState(moleculeIndex) == DEATH) continue;
+
+        predictWallEvent(moleculeIndex);
+        predictMoleculeEvents(moleculeIndex, endTimePoint, /*onlyLaterNeighbours=*/true);
     }
 
-    reactionFunc(moleculeList, fstMoleculeIT, sndMoleculeIT);
+    while (!coreEventsHeap.empty() && coreEventsHeap.front().timePoint <= endTimePoint) {
+        std::pop_heap(coreEventsHeap.begin(), coreEventsHeap.end(), std::greater<CoreEvent>());
+        CoreEvent event = coreEventsHeap.back();
+        coreEventsHeap.pop_back();
+
+        if (!isCoreEventValid(event)) continue;
+
+        size_t fstMoleculeIndex = event.fstMoleculeIndex;
+        size_t sndMoleculeIndex = event.sndMoleculeIndex;
+
+        if (sndMoleculeIndex == NONE_MOLECULE_INDEX) {
+            driftMolecule(fstMoleculeIndex, event.timePoint);
+
+            gm_vector<double, 2> speedVector = moleculeStore.getSpeedVector(fstMoleculeIndex);
+            gm_vector<double, 2> newSpeedVector = processWallCollision(speedVector, event.wallType);
+            moleculeStore.setSpeedVector(fstMoleculeIndex, newSpeedVector);
+            observables.addWallHit(event.wallType, moleculeStore.getMass(fstMoleculeIndex), speedVector, newSpeedVector);
+            moleculeEventsCnts[fstMoleculeIndex]++;
+
+            predictWallEvent(fstMoleculeIndex);
+            if (moleculeStore.getPhysicalState(fstMoleculeIndex) == ALIVE)
+                predictMoleculeEvents(fstMoleculeIndex, endTimePoint, /*onlyLaterNeighbours=*/false);
+            continue;
+        }
+
+        driftMolecule(fstMoleculeIndex, event.timePoint);
+        driftMolecule(sndMoleculeIndex, event.timePoint);
+
+        size_t prevMoleculesCnt = moleculeStore.size();
+        reactMolecules(fstMoleculeIndex, sndMoleculeIndex);
+        moleculeEventsCnts[fstMoleculeIndex]++;
+        moleculeEventsCnts[sndMoleculeIndex]++;
+
+        // reaction products stay UNRESPONSIVE till the end of the update, so they only hit walls
+        for (size_t newMoleculeIndex = prevMoleculesCnt; newMoleculeIndex < moleculeStore.size(); newMoleculeIndex++) {
+            moleculeTimePoints.push_back(event.timePoint);
+            moleculeEventsCnts.push_back(0);
+            predictWallEvent(newMoleculeIndex);
+        }
+    }
+
+    closestEventTimePoint = std::numeric_limits<double>::quiet_NaN();
+    while (!coreEventsHeap.empty()) {
+        if (isCoreEventValid(coreEventsHeap.front())) {
+            closestEventTimePoint = coreEventsHeap.front().timePoint;
+            break;
+        }
+        std::pop_heap(coreEventsHeap.begin(), coreEventsHeap.end(), std::greater<CoreEvent>());
+        coreEventsHeap.pop_back();
+    }
+
+    for (size_t moleculeIndex = 0; moleculeIndex < moleculeStore.size(); moleculeIndex++) {
+        if (moleculeStore.getPhysicalState(moleculeIndex) != DEATH)
+            driftMolecule(moleculeIndex, endTimePoint);
+    }
+}
+
+void ReactorCore::buildEventNeighbours(const double deltaSecs) {
+    size_t moleculesCnt = moleculeStore.size();
+
+    moleculeNeighbourStarts.assign(moleculesCnt + 1, 0);
+    moleculeNeighbours.clear();
+    if (moleculesCnt < 2) return;
+
+    const double *collideRadiuses = moleculeStore.getCollideRadiuses();
+    const double *speedXs = moleculeStore.getSpeedXs();
+    const double *speedYs = moleculeStore.getSpeedYs();
+
+    double maxCollideCircleRadius = 0;
+    double maxSpeed2 = 0;
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        maxCollideCircleRadius = std::max(maxCollideCircleRadius, collideRadiuses[i]);
+        maxSpeed2 = std::max(maxSpeed2, speedXs[i] * speedXs[i] + speedYs[i] * speedYs[i]);
+    }
+
+    // Fixed wall hits keep the speed value, a piston hit adds up to 2 |pistonSpeed| to it. Another
+    // piston hit takes a round trip over the whole box, so during the update no molecule gets further
+    // than (maxSpeed + 2 |pistonSpeed|) * deltaSecs from its start position.
+    double maxTravelSpeed = std::sqrt(maxSpeed2) + 2 * std::abs(pistonSpeed);
+    double maxReachDistance = 2 * maxCollideCircleRadius + 2 * maxTravelSpeed * deltaSecs;
+    double gridCellSize = std::sqrt(maxReachDistance * maxReachDistance + DISTANCE_COLLISION_EPS2) + DISTANCE_COLLISION_EPS;
+
+    spatialGrid.rebuild(moleculeStore.getXs(), moleculeStore.getYs(), moleculesCnt,
+                        gridCellSize, pistonPosition, cordSysWidth - pistonPosition, cordSysHeight);
+
+    tickCandidatePairs.clear();
+    spatialGrid.forEachCandidatePair([this](const size_t fst, const size_t snd) {
+        tickCandidatePairs.emplace_back(fst, snd);
+        tickCandidatePairs.emplace_back(snd, fst);
+    });
+
+    std::sort(tickCandidatePairs.begin(), tickCandidatePairs.end());
+
+    moleculeNeighbours.reserve(tickCandidatePairs.size());
+    for (const auto &[fst, snd] : tickCandidatePairs) {
+        moleculeNeighbourStarts[fst + 1]++;
+        moleculeNeighbours.push_back(snd);
+    }
+
+    for (size_t i = 0; i < moleculesCnt; i++)
+        moleculeNeighbourStarts[i + 1] += moleculeNeighbourStarts[i];
 }
 
+void ReactorCore::driftMolecule(const size_t moleculeIndex, const double timePoint) {
+    double driftDelta = timePoint - moleculeTimePoints[moleculeIndex];
+    if (driftDelta == 0) return;
+
+    updateMoleculePosition(moleculeIndex, driftDelta);
+    moleculeTimePoints[moleculeIndex] = timePoint;
+}
+
+void ReactorCore::predictWallEvent(const size_t moleculeIndex) {
+    double wallDelta = std::numeric_limits<double>::quiet_NaN();
+    WallType hitWallType = NONE_WALL;
+
+    for (size_t i = 0; i < WALLS_CNT; i++) {
+        WallType wallType = WallType (i);
+
+        // a molecule reflected on a wall lies on it, only walls ahead are taken into account
+        if (!isMovingTowardsWall(moleculeIndex, wallType)) continue;
+
+        double intersectionDelta = getWallIntersectionDelta(moleculeIndex, wallType);
+        if (std::isnan(intersectionDelta)) continue;
+
+        if (std::isnan(wallDelta) || intersectionDelta < wallDelta) {
+            wallDelta = intersectionDelta;
+            hitWallType = wallType;
+        }
+    }
+
+    if (hitWallType == NONE_WALL) return;
+
+    pushCoreEvent({moleculeTimePoints[moleculeIndex] + wallDelta, moleculeIndex, NONE_MOLECULE_INDEX,
+                   hitWallType, moleculeEventsCnts[moleculeIndex], 0});
+}
+
+void ReactorCore::predictMoleculeEvents(const size_t moleculeIndex, const double endTimePoint, const bool onlyLaterNeighbours) {
+    double nowTimePoint = moleculeTimePoints[moleculeIndex];
+
+    // neighbours are gathered into SoA blocks for the batched time-of-impact kernel
+    alignas(MOLECULE_STORE_ALIGNMENT) double batchXs[IMPACT_BATCH_MAX_SIZE];
+    alignas(MOLECULE_STORE_ALIGNMENT) double batchYs[IMPACT_BATCH_MAX_SIZE];
+    alignas(MOLECULE_STORE_ALIGNMENT) double batchSpeedXs[IMPACT_BATCH_MAX_SIZE];
+    alignas(MOLECULE_STORE_ALIGNMENT) double batchSpeedYs[IMPACT_BATCH_MAX_SIZE];
+    alignas(MOLECULE_STORE_ALIGNMENT) double batchCollideRadiuses[IMPACT_BATCH_MAX_SIZE];
+    alignas(MOLECULE_STORE_ALIGNMENT) double batchImpactDeltas[IMPACT_BATCH_MAX_SIZE];
+    size_t batchMoleculeIndices[IMPACT_BATCH_MAX_SIZE];
+    size_t batchSize = 0;
+
+    auto pushBatchEvents = [&]() {
+        uint64_t hitsMask = computeImpactDeltas(
+            moleculeStore.getXs()[moleculeIndex], moleculeStore.getYs()[moleculeIndex],
+            moleculeStore.getSpeedXs()[moleculeIndex], moleculeStore.getSpeedYs()[moleculeIndex],
+            moleculeStore.getCollideCircleRadius(moleculeIndex),
+            batchXs, batchYs, batchSpeedXs, batchSpeedYs, batchCollideRadiuses,
+            batchSize, /*maxDelta=*/endTimePoint - nowTimePoint, batchImpactDeltas
+        );
+
+        for (size_t i = 0; i < batchSize; i++) {
+            size_t neighbourIndex = batchMoleculeIndices[i];
+
+            double collisionDelta = 0;
+            if (!isMoleculesInContact(moleculeIndex, neighbourIndex)) {
+                bool isCirclesHit = hitsMask >> i & 1;
+
+                if (isCollideCircleExact(moleculeIndex) && isCollideCircleExact(neighbourIndex)) {
+                    if (!isCirclesHit) continue;
+                    collisionDelta = batchImpactDeltas[i];
+                } else {
+                    // a square meets nothing before its collide circle does, unless the circles overlap already
+                    double collisionDistance = moleculeStore.getCollideCircleRadius(moleculeIndex) + batchCollideRadiuses[i];
+                    bool isCirclesOverlapping = (moleculeStore.getPosition(moleculeIndex) - moleculeStore.getPosition(neighbourIndex)).get_len2() <
+                                                collisionDistance * collisionDistance;
+                    if (!isCirclesHit && !isCirclesOverlapping) continue;
+
+                    collisionDelta = getMoleculeShapesCollisionDelta(moleculeIndex, neighbourIndex);
+                    if (std::isnan(collisionDelta)) continue;
+                }
+            }
+            if (nowTimePoint + collisionDelta > endTimePoint) continue;
+
+            size_t fstMoleculeIndex = std::min(moleculeIndex, neighbourIndex);
+            size_t sndMoleculeIndex = std::max(moleculeIndex, neighbourIndex);
+
+            pushCoreEvent({nowTimePoint + collisionDelta, fstMoleculeIndex, sndMoleculeIndex, NONE_WALL,
+                           moleculeEventsCnts[fstMoleculeIndex], moleculeEventsCnts[sndMoleculeIndex]});
+        }
+
+        batchSize = 0;
+    };
+
+    for (size_t i = moleculeNeighbourStarts[moleculeIndex]; i < moleculeNeighbourStarts[moleculeIndex + 1]; i++) {
+        size_t neighbourIndex = moleculeNeighbours[i];
+
+        if (onlyLaterNeighbours && neighbourIndex < moleculeIndex) continue;
+        if (moleculeStore.getPhysicalState(neighbourIndex) != ALIVE) continue;
+
+        driftMolecule(neighbourIndex, nowTimePoint);
+
+        batchXs[batchSize] = moleculeStore.getXs()[neighbourIndex];
+        batchYs[batchSize] = moleculeStore.getYs()[neighbourIndex];
+        batchSpeedXs[batchSize] = moleculeStore.getSpeedXs()[neighbourIndex];
+        batchSpeedYs[batchSize] = moleculeStore.getSpeedYs()[neighbourIndex];
+        batchCollideRadiuses[batchSize] = moleculeStore.getCollideCircleRadius(neighbourIndex);
+        batchMoleculeIndices[batchSize] = neighbourIndex;
+
+        if (++batchSize == IMPACT_BATCH_MAX_SIZE) pushBatchEvents();
+    }
+
+    if (batchSize > 0) pushBatchEvents();
+}
+
+void ReactorCore::pushCoreEvent(const CoreEvent &event) {
+    coreEventsHeap.push_back(event);
+    std::push_heap(coreEventsHeap.begin(), coreEventsHeap.end(), std::greater<CoreEvent>());
+}
+
+bool ReactorCore::isCoreEventValid(const CoreEvent &event) const {
+    if (moleculeStore.getPhysicalState(event.fstMoleculeIndex) == DEATH) return false;
+    if (moleculeEventsCnts[event.fstMoleculeIndex] != event.fstEventsCnt) return false;
+
+    if (event.sndMoleculeIndex == NONE_MOLECULE_INDEX) return true;
+
+    return moleculeStore.getPhysicalState(event.fstMoleculeIndex) == ALIVE &&
+           moleculeStore.getPhysicalState(event.sndMoleculeIndex) == ALIVE &&
+           moleculeEventsCnts[event.sndMoleculeIndex] == event.sndEventsCnt;
+}
+
+
+void ReactorCore::fillRenderSnapshot(RenderSnapshot &snapshot) const {
+    size_t moleculesCnt = moleculeStore.size();
+    snapshot.resize(moleculesCnt);
+
+    const double *xs = moleculeStore.getXs();
+    const double *ys = moleculeStore.getYs();
+    const int *masses = moleculeStore.getMasses();
+    const MoleculeTypes *types = moleculeStore.getMoleculeTypes();
+    const MoleculePhysicalStates *states = moleculeStore.getPhysicalStates();
+
+    // dead molecules waiting for compaction are overwritten by the next living one
+    size_t shownCnt = 0;
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        snapshot.xs[shownCnt] = float(xs[i]);
+        snapshot.ys[shownCnt] = float(ys[i]);
+        snapshot.sizes[shownCnt] = float(getMoleculeSize(types[i], masses[i]));
+        snapshot.shapeTypes[shownCnt] = getMoleculeShapeType(types[i]);
+        snapshot.colors[shownCnt] = packRenderColor(getMoleculeColor(types[i]));
+
+        shownCnt += states[i] != DEATH;
+    }
+    snapshot.resize(shownCnt);
+
+    snapshot.pistonPosition = pistonPosition;
+    snapshot.timePoint = currentReactorCoreTime;
+}
+
+void ReactorCore::fillCoreMetricsSample(CoreMetricsSample &sample) const {
+    sample.timePoint = currentReactorCoreTime;
+    sample.circlitsCnt = observables.getMoleculesCnt(CIRCLIT);
+    sample.quadritsCnt = observables.getMoleculesCnt(QUADRIT);
+    sample.kineticEnergy = observables.getKineticEnergy();
+    sample.pressure = observables.getPressure();
+}
+
+
+size_t ReactorCore::addMolecules(const MoleculeTypes moleculeType, const size_t moleculesCnt, const SpawnDistribution distribution) {
+    assert(moleculeType == CIRCLIT || moleculeType == QUADRIT);
+    if (moleculesCnt == 0) return 0;
+
+    std::vector<double> uniforms(moleculesCnt * MOLECULE_INIT_UNIFORMS_CNT);
+    genMoleculeInitUniforms(moleculesCnt, uniforms.data());
+
+    std::vector<double> spawnXs(moleculesCnt);
+    std::vector<double> spawnYs(moleculesCnt);
+    size_t spawnedCnt = 0;
+
+    switch (distribution) {
+        case UNIFORM_SPAWN:
+            for (size_t i = 0; i < moleculesCnt; i++) {
+                spawnXs[i] = pistonPosition + (cordSysWidth - pistonPosition) * uniforms[i * MOLECULE_INIT_UNIFORMS_CNT];
+                spawnYs[i] = cordSysHeight * uniforms[i * MOLECULE_INIT_UNIFORMS_CNT + 1];
+            }
+            spawnedCnt = moleculesCnt;
+            break;
+        case POISSON_DISK_SPAWN:
+            spawnedCnt = placeMoleculesPoissonDisk(moleculeType, moleculesCnt, uniforms.data(), spawnXs.data(), spawnYs.data());
+            break;
+        default:
+            assert(0 && "unknown distribution");
+    }
+
+    size_t moleculeIndex = moleculeStore.appendMolecules(moleculeType, spawnedCnt, INITIAL_MASS);
+    double *xs = moleculeStore.getXs();
+    double *ys = moleculeStore.getYs();
+    double *speedXs = moleculeStore.getSpeedXs();
+    double *speedYs = moleculeStore.getSpeedYs();
+
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        if (std::isnan(spawnXs[i])) continue; // no place found by Poisson disk sampling
+
+        double randomAngle = 2 * std::numbers::pi * uniforms[i * MOLECULE_INIT_UNIFORMS_CNT + 2];
+        double randomSpeed = MoleculeMinInitSpeed + (MoleculeMaxInitSpeed - MoleculeMinInitSpeed) * uniforms[i * MOLECULE_INIT_UNIFORMS_CNT + 3];
+
+        // (0, randomSpeed) rotated by randomAngle
+        xs[moleculeIndex] = spawnXs[i];
+        ys[moleculeIndex] = spawnYs[i];
+        speedXs[moleculeIndex] = -randomSpeed * std::sin(randomAngle);
+        speedYs[moleculeIndex] = randomSpeed * std::cos(randomAngle);
+        moleculeIndex++;
+    }
+
+    observables.addMolecules(moleculeStore, moleculeStore.size() - spawnedCnt, moleculeStore.size());
+    spawnedMoleculesCnt += moleculesCnt;
+    return spawnedCnt;
+}
+
+void ReactorCore::genMoleculeInitUniforms(const size_t moleculesCnt, double *uniforms) const {
+    auto genUniformsRange = [this, uniforms](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++)
+            randomGenerator.generateUniforms(spawnedMoleculesCnt + i, 0, uniforms + i * MOLECULE_INIT_UNIFORMS_CNT, MOLECULE_INIT_UNIFORMS_CNT);
+    };
+
+    if (workerPool) workerPool->parallelFor(moleculesCnt, genUniformsRange);
+    else            genUniformsRange(0, moleculesCnt);
+}
+
+// Dart throwing over a background grid: the i-th molecule tries its uniform position first, then up
+// to POISSON_DISK_MAX_ATTEMPTS - 1 more positions from its own stream. Dropped molecules get NaN cords.
+size_t ReactorCore::placeMoleculesPoissonDisk
+(
+    const MoleculeTypes moleculeType, const size_t moleculesCnt,
+    const double *uniforms, double *xs, double *ys
+) const {
+    auto getConflictDistance = [](const double fstRadius, const double sndRadius) {
+        double collisionDistance = fstRadius + sndRadius;
+        return std::sqrt(collisionDistance * collisionDistance + DISTANCE_COLLISION_EPS2) + DISTANCE_COLLISION_EPS;
+    };
+
+    size_t presentCnt = moleculeStore.size();
+    double newRadius = getMoleculeCollideCircleRadius(moleculeType, INITIAL_MASS);
+
+    const double *presentRadiuses = moleculeStore.getCollideRadiuses();
+    double maxRadius = newRadius;
+    for (size_t i = 0; i < presentCnt; i++)
+        maxRadius = std::max(maxRadius, presentRadiuses[i]);
+
+    // with cells of minDistance / sqrt(2) every cell holds at most one new molecule
+    double cellSize = getConflictDistance(newRadius, newRadius) / SQRT_2;
+    size_t maxCellsCnt = std::max(SPATIAL_GRID_MIN_CELLS, (presentCnt + moleculesCnt) * POISSON_DISK_MAX_CELLS_PER_MOLECULE);
+    if ((cordSysWidth / cellSize) * (cordSysHeight / cellSize) > double(maxCellsCnt))
+        cellSize = std::sqrt(cordSysWidth * cordSysHeight / double(maxCellsCnt));
+
+    long cols = std::max(1l, long(std::ceil(cordSysWidth / cellSize)));
+    long rows = std::max(1l, long(std::ceil(cordSysHeight / cellSize)));
+    long reach = long(std::ceil(getConflictDistance(newRadius, maxRadius) / cellSize));
+
+    auto getAxisCell = [cellSize](const double cord, const long axisCellsCnt) {
+        double cell = std::floor(cord / cellSize);
+        if (!(cell > 0)) return 0l;
+        return std::min(axisCellsCnt - 1, long(cell));
+    };
+
+    std::vector<size_t> cellHeads(cols * rows, NONE_MOLECULE_INDEX);
+    std::vector<size_t> pointNexts;
+    std::vector<double> pointXs;
+    std::vector<double> pointYs;
+    std::vector<double> pointRadiuses;
+
+    auto insertPoint = [&](const double x, const double y, const double radius) {
+        size_t cell = getAxisCell(y, rows) * cols + getAxisCell(x, cols);
+
+        pointNexts.push_back(cellHeads[cell]);
+        pointXs.push_back(x);
+        pointYs.push_back(y);
+        pointRadiuses.push_back(radius);
+        cellHeads[cell] = pointXs.size() - 1;
+    };
+
+    auto isPlaceFree = [&](const double x, const double y) {
+        long col = getAxisCell(x, cols);
+        long row = getAxisCell(y, rows);
+
+        for (long neighbourRow = std::max(0l, row - reach); neighbourRow <= std::min(rows - 1, row + reach); neighbourRow++) {
+            for (long neighbourCol = std::max(0l, col - reach); neighbourCol <= std::min(cols - 1, col + reach); neighbourCol++) {
+                for (size_t point = cellHeads[neighbourRow * cols + neighbourCol]; point != NONE_MOLECULE_INDEX; point = pointNexts[point]) {
+                    double dx = pointXs[point] - x;
+                    double dy = pointYs[point] - y;
+                    double conflictDistance = getConflictDistance(newRadius, pointRadiuses[point]);
+
+                    if (dx * dx + dy * dy < conflictDistance * conflictDistance) return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    pointXs.reserve(presentCnt + moleculesCnt);
+    pointYs.reserve(presentCnt + moleculesCnt);
+    pointRadiuses.reserve(presentCnt + moleculesCnt);
+    pointNexts.reserve(presentCnt + moleculesCnt);
+
+    for (size_t i = 0; i < presentCnt; i++)
+        insertPoint(moleculeStore.getXs()[i], moleculeStore.getYs()[i], presentRadiuses[i]);
+
+    size_t placedCnt = 0;
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        xs[i] = ys[i] = std::numeric_limits<double>::quiet_NaN();
+
+        for (size_t attempt = 0; attempt < POISSON_DISK_MAX_ATTEMPTS; attempt++) {
+            double candidateUniforms[2] = {uniforms[i * MOLECULE_INIT_UNIFORMS_CNT], uniforms[i * MOLECULE_INIT_UNIFORMS_CNT + 1]};
+            if (attempt > 0)
+                randomGenerator.generateUniforms(spawnedMoleculesCnt + i, MOLECULE_INIT_UNIFORMS_CNT + 2 * (attempt - 1), candidateUniforms, 2);
+
+            double x = pistonPosition + (cordSysWidth - pistonPosition) * candidateUniforms[0];
+            double y = cordSysHeight * candidateUniforms[1];
+            if (!isPlaceFree(x, y)) continue;
+
+            insertPoint(x, y, newRadius);
+            xs[i] = x;
+            ys[i] = y;
+            placedCnt++;
+            break;
+        }
+    }
+
+    return placedCnt;
+}
@@ -1,48 +1,175 @@
-// #include <QVBoxLayout>
-// #include <QtMath>
+#include <QVBoxLayout>
 
-// #include "record_widget.h"
+#include <algorithm>
+#include <cassert>
 
+#include "record_widget.h"
 
-// RecorderWidget::RecorderWidget(QWidget *parent)
-//     : QWidget(parent), t(0), maxPoints(200)
-// {
-    
 
-//     QVBoxLayout *layout = new QVBoxLayout(this);
+RecorderHistory::RecorderHistory(const size_t capacity) :
+    timePoints(capacity), oldestSlot(0), samplesCnt(0)
+{
+    assert(capacity > 0);
 
-//     plot = new QCustomPlot(this);
-//     plot->addGraph();
-//     plot->xAxis->setLabel("Time (s)");
-//     plot->yAxis->setLabel("Value");
-//     plot->xAxis->setRange(0, 10);
-//     plot->yAxis->setRange(-1, 1);
-//     plot->setInteraction(QCP::iRangeDrag);
-//     plot->setInteraction(QCP::iRangeZoom);
-//     // plot->setMinimumSize(300, 200);
+    for (std::vector<double> &values : seriesValues)
+        values.resize(capacity);
+}
 
-//     layout->addWidget(plot);
+void RecorderHistory::push(const CoreMetricsSample &sample) {
+    size_t slot = 0;
+    if (samplesCnt < timePoints.size()) {
+        slot = getSlot(samplesCnt++);
+    } else {
+        slot = oldestSlot;
+        oldestSlot = getSlot(1);
+    }
 
-//     timer = new QTimer(this);
-//     connect(timer, &QTimer::timeout, this, &RecorderWidget::updatePlot);
-//     timer->start(50); // 20 Hz
-// }
+    timePoints[slot] = sample.timePoint;
+    seriesValues[CIRCLITS_SERIES][slot] = double(sample.circlitsCnt);
+    seriesValues[QUADRITS_SERIES][slot] = double(sample.quadritsCnt);
+    seriesValues[KINETIC_ENERGY_SERIES][slot] = sample.kineticEnergy;
+    seriesValues[PRESSURE_SERIES][slot] = sample.pressure;
+}
 
-// void RecorderWidget::updatePlot()
-// {
-//     t += 0.05; // simulation step
+size_t RecorderHistory::findFirstSample(const double timePoint) const {
+    size_t lowIndex = 0;
+    size_t highIndex = samplesCnt;
 
-//     double val = qSin(t); // example value (replace with your app data)
+    while (lowIndex < highIndex) {
+        size_t midIndex = lowIndex + (highIndex - lowIndex) / 2;
 
-//     xData.append(t);
-//     yData.append(val);
+        if (getTimePoint(midIndex) < timePoint)
+            lowIndex = midIndex + 1;
+        else
+            highIndex = midIndex;
+    }
 
-//     if (xData.size() > maxPoints) {
-//         xData.remove(0, 1);
-//         yData.remove(0, 1);
-//     }
+    return lowIndex;
+}
 
-//     plot->graph(0)->setData(xData, yData);
-//     plot->xAxis->setRange(t - 10, t); // last 10 seconds
-//     plot->replot();
-// }
+
+void decimateRecorderSeries
+(
+    const RecorderHistory &history, const RecorderSeries series,
+    const double startTimePoint, const double endTimePoint, const int columnsCnt,
+    QVector<double> &keys, QVector<double> &values
+) {
+    assert(columnsCnt > 0);
+    assert(endTimePoint > startTimePoint);
+
+    keys.clear();
+    values.clear();
+
+    double columnSecs = (endTimePoint - startTimePoint) / columnsCnt;
+    // the last column is closed, so samples right at endTimePoint land in it
+    auto getColumn = [&](const double timePoint) {
+        return std::min(columnsCnt - 1, int((timePoint - startTimePoint) / columnSecs));
+    };
+
+    size_t sampleIndex = history.findFirstSample(startTimePoint);
+    size_t samplesEnd = sampleIndex;
+    while (samplesEnd < history.size() && history.getTimePoint(samplesEnd) <= endTimePoint) samplesEnd++;
+
+    while (sampleIndex < samplesEnd) {
+        int column = getColumn(history.getTimePoint(sampleIndex));
+
+        size_t minIndex = sampleIndex;
+        size_t maxIndex = sampleIndex;
+
+        for (sampleIndex++; sampleIndex < samplesEnd && getColumn(history.getTimePoint(sampleIndex)) == column; sampleIndex++) {
+            double value = history.getValue(series, sampleIndex);
+            if (value < history.getValue(series, minIndex)) minIndex = sampleIndex;
+            if (value > history.getValue(series, maxIndex)) maxIndex = sampleIndex;
+        }
+
+        size_t fstIndex = std::min(minIndex, maxIndex);
+        size_t sndIndex = std::max(minIndex, maxIndex);
+
+        keys.push_back(history.getTimePoint(fstIndex));
+        values.push_back(history.getValue(series, fstIndex));
+
+        if (sndIndex != fstIndex) {
+            keys.push_back(history.getTimePoint(sndIndex));
+            values.push_back(history.getValue(series, sndIndex));
+        }
+    }
+}
+
+
+static QCPGraph *addRecorderGraph(QCustomPlot *plot, QCPAxisRect *axisRect, const QString &name, const QColor &color) {
+    QCPGraph *graph = plot->addGraph(axisRect->axis(QCPAxis::atBottom), axisRect->axis(QCPAxis::atLeft));
+    graph->setName(name);
+    graph->setPen(QPen(color));
+
+    return graph;
+}
+
+static QColor getMoleculeQColor(const MoleculeTypes moleculeType) {
+    gm_vector<unsigned char, 3> color = getMoleculeColor(moleculeType);
+    return QColor(color.get_x(), color.get_y(), color.get_z());
+}
+
+RecorderWidget::RecorderWidget(ReactorCoreAdapter *reactorCore, QWidget *parent) :
+    QWidget(parent), reactorCore(reactorCore)
+{
+    assert(reactorCore);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    plot = new QCustomPlot(this);
+    layout->addWidget(plot);
+
+    QCPAxisRect *countsRect = plot->axisRect();
+    QCPAxisRect *energyRect = new QCPAxisRect(plot);
+    QCPAxisRect *pressureRect = new QCPAxisRect(plot);
+    plot->plotLayout()->addElement(1, 0, energyRect);
+    plot->plotLayout()->addElement(2, 0, pressureRect);
+
+    seriesGraphs[CIRCLITS_SERIES] = addRecorderGraph(plot, countsRect, "Circlits", getMoleculeQColor(CIRCLIT));
+    seriesGraphs[QUADRITS_SERIES] = addRecorderGraph(plot, countsRect, "Quadrits", getMoleculeQColor(QUADRIT));
+    seriesGraphs[KINETIC_ENERGY_SERIES] = addRecorderGraph(plot, energyRect, "Kinetic energy", Qt::darkRed);
+    seriesGraphs[PRESSURE_SERIES] = addRecorderGraph(plot, pressureRect, "Pressure", Qt::darkBlue);
+
+    seriesGraphs[KINETIC_ENERGY_SERIES]->removeFromLegend();
+    seriesGraphs[PRESSURE_SERIES]->removeFromLegend();
+    plot->legend->setVisible(true);
+
+    countsRect->axis(QCPAxis::atLeft)->setLabel("Molecules");
+    energyRect->axis(QCPAxis::atLeft)->setLabel("Kinetic energy");
+    pressureRect->axis(QCPAxis::atLeft)->setLabel("Pressure");
+    pressureRect->axis(QCPAxis::atBottom)->setLabel("Time (s)");
+
+    // the core publishes a snapshot every step, so this fires at frame rate while it runs
+    connect(reactorCore, &ReactorCoreAdapter::reactorCoreUpdated, this, &RecorderWidget::updatePlot);
+}
+
+void RecorderWidget::updatePlot() {
+    CoreMetricsSample sample;
+    while (reactorCore->popCoreMetricsSample(sample)) {
+        // core time only goes back when a snapshot is loaded, the old history is then meaningless
+        if (history.size() > 0 && sample.timePoint < history.getTimePoint(history.size() - 1))
+            history.clear();
+
+        history.push(sample);
+    }
+
+    if (history.size() == 0) return;
+
+    double endTimePoint = history.getTimePoint(history.size() - 1);
+    double startTimePoint = endTimePoint - RECORDER_WINDOW_SECS;
+
+    for (size_t series = 0; series < RECORDER_SERIES_CNT; series++) {
+        QCPGraph *graph = seriesGraphs[series];
+        int columnsCnt = std::max(1, graph->keyAxis()->axisRect()->width());
+
+        decimateRecorderSeries(history, RecorderSeries(series), startTimePoint, endTimePoint, columnsCnt, decimatedKeys, decimatedValues);
+        graph->setData(decimatedKeys, decimatedValues, /*alreadySorted=*/true);
+    }
+
+    for (QCPAxisRect *axisRect : plot->axisRects()) {
+        axisRect->axis(QCPAxis::atBottom)->setRange(startTimePoint, endTimePoint);
+        axisRect->axis(QCPAxis::atLeft)->rescale();
+    }
+
+    plot->replot(QCustomPlot::rpQueuedReplot);
+}
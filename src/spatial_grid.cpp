@@ -0,0 +1,51 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+size_t UniformSpatialGrid::getAxisCell(const double cord, const size_t axisCellsCnt) const {
+    double cell = std::floor(cord / cellSize);
+
+    if (!(cell > 0)) return 0; // also catches NaN
+    if (cell >= double(axisCellsCnt - 1)) return axisCellsCnt - 1;
+    return size_t(cell);
+}
+
+void UniformSpatialGrid::rebuild
+(
+    const double *xs, const double *ys, const size_t itemsCnt,
+    const double minCellSize, const double originX, const double width, const double height
+) {
+    assert(minCellSize > 0);
+
+    cellSize = minCellSize;
+
+    size_t maxCellsCnt = std::max(SPATIAL_GRID_MIN_CELLS, itemsCnt * SPATIAL_GRID_MAX_CELLS_PER_ITEM);
+    if (width > 0 && height > 0 && (width / cellSize) * (height / cellSize) > double(maxCellsCnt))
+        cellSize = std::sqrt(width * height / double(maxCellsCnt));
+
+    cols = (width > 0)  ? std::max<size_t>(1, size_t(std::ceil(width / cellSize)))  : 1;
+    rows = (height > 0) ? std::max<size_t>(1, size_t(std::ceil(height / cellSize))) : 1;
+
+    itemCells.resize(itemsCnt);
+    cellStarts.assign(cols * rows + 1, 0);
+    cellItems.resize(itemsCnt);
+
+    for (size_t i = 0; i < itemsCnt; i++) {
+        itemCells[i] = getAxisCell(ys[i], rows) * cols + getAxisCell(xs[i] - originX, cols);
+        cellStarts[itemCells[i] + 1]++;
+    }
+
+    for (size_t cell = 0; cell < cols * rows; cell++)
+        cellStarts[cell + 1] += cellStarts[cell];
+
+    // scatter shifts every cellStart to the next cell's one; items keep ascending order inside a cell
+    for (size_t i = 0; i < itemsCnt; i++)
+        cellItems[cellStarts[itemCells[i]]++] = i;
+
+    for (size_t cell = cols * rows; cell > 0; cell--)
+        cellStarts[cell] = cellStarts[cell - 1];
+    cellStarts[0] = 0;
+}
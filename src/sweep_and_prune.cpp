@@ -0,0 +1,127 @@
+#include "sweep_and_prune.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+
+static const size_t NONE_SWEEP_ITEM = std::numeric_limits<size_t>::max();
+
+void SweepAndPrune::reserve(const size_t itemsCnt) {
+    for (std::vector<double> *bounds : {&minXs, &maxXs, &minYs, &maxYs, &mergedMinXs})
+        bounds->reserve(itemsCnt);
+
+    sortedItems.reserve(itemsCnt);
+    sortedKeys.reserve(itemsCnt);
+    keyItems.reserve(itemsCnt);
+    isItemPlaced.reserve(itemsCnt);
+    insertedItems.reserve(itemsCnt);
+    mergedItems.reserve(itemsCnt);
+}
+
+void SweepAndPrune::update
+(
+    const double *xs, const double *ys, const double *radiuses, const uint32_t *keys,
+    const size_t itemsCnt, const double margin
+) {
+    uint32_t maxKey = 0;
+    for (size_t i = 0; i < itemsCnt; i++)
+        maxKey = std::max(maxKey, keys[i]);
+
+    keyItems.assign(size_t(maxKey) + 1, NONE_SWEEP_ITEM);
+    for (size_t i = 0; i < itemsCnt; i++)
+        keyItems[keys[i]] = i;
+
+    // items still present keep their previous order, which is almost sorted after a step
+    isItemPlaced.assign(itemsCnt, false);
+    minXs.clear();
+    sortedItems.clear();
+
+    for (uint32_t key : sortedKeys) {
+        size_t item = (key <= maxKey) ? keyItems[key] : NONE_SWEEP_ITEM;
+        if (item == NONE_SWEEP_ITEM || isItemPlaced[item]) continue;
+
+        isItemPlaced[item] = true;
+        minXs.push_back(xs[item] - radiuses[item] - margin);
+        sortedItems.push_back(item);
+    }
+
+    insertedItems.clear();
+    for (size_t i = 0; i < itemsCnt; i++) {
+        if (!isItemPlaced[i]) insertedItems.push_back(i);
+    }
+
+    if (insertedItems.size() <= SWEEP_AND_PRUNE_MAX_INSERTED_SHARE * sortedItems.size()) {
+        for (size_t item : insertedItems) {
+            minXs.push_back(xs[item] - radiuses[item] - margin);
+            sortedItems.push_back(item);
+        }
+        insertionSort();
+    } else {
+        insertionSort();
+        mergeInserted(xs, radiuses, margin);
+    }
+
+    assert(sortedItems.size() == itemsCnt);
+
+    maxXs.resize(itemsCnt);
+    minYs.resize(itemsCnt);
+    maxYs.resize(itemsCnt);
+    sortedKeys.resize(itemsCnt);
+
+    for (size_t slot = 0; slot < itemsCnt; slot++) {
+        size_t item = sortedItems[slot];
+        double halfSide = radiuses[item] + margin;
+
+        maxXs[slot] = xs[item] + halfSide;
+        minYs[slot] = ys[item] - halfSide;
+        maxYs[slot] = ys[item] + halfSide;
+        sortedKeys[slot] = keys[item];
+    }
+}
+
+void SweepAndPrune::insertionSort() {
+    for (size_t slot = 1; slot < minXs.size(); slot++) {
+        double minX = minXs[slot];
+        size_t item = sortedItems[slot];
+
+        size_t insertSlot = slot;
+        for (; insertSlot > 0 && minXs[insertSlot - 1] > minX; insertSlot--) {
+            minXs[insertSlot] = minXs[insertSlot - 1];
+            sortedItems[insertSlot] = sortedItems[insertSlot - 1];
+        }
+
+        minXs[insertSlot] = minX;
+        sortedItems[insertSlot] = item;
+    }
+}
+
+void SweepAndPrune::mergeInserted(const double *xs, const double *radiuses, const double margin) {
+    auto getMinX = [=](const size_t item) { return xs[item] - radiuses[item] - margin; };
+
+    std::sort(insertedItems.begin(), insertedItems.end(), [&](const size_t fst, const size_t snd) {
+        return getMinX(fst) < getMinX(snd);
+    });
+
+    size_t mergedCnt = sortedItems.size() + insertedItems.size();
+    mergedMinXs.resize(mergedCnt);
+    mergedItems.resize(mergedCnt);
+
+    size_t sortedSlot = 0;
+    size_t insertedSlot = 0;
+    for (size_t mergedSlot = 0; mergedSlot < mergedCnt; mergedSlot++) {
+        bool isSortedTaken = insertedSlot == insertedItems.size() ||
+            (sortedSlot < sortedItems.size() && minXs[sortedSlot] <= getMinX(insertedItems[insertedSlot]));
+
+        if (isSortedTaken) {
+            mergedMinXs[mergedSlot] = minXs[sortedSlot];
+            mergedItems[mergedSlot] = sortedItems[sortedSlot++];
+        } else {
+            mergedMinXs[mergedSlot] = getMinX(insertedItems[insertedSlot]);
+            mergedItems[mergedSlot] = insertedItems[insertedSlot++];
+        }
+    }
+
+    minXs.swap(mergedMinXs);
+    sortedItems.swap(mergedItems);
+}
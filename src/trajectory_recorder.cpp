@@ -0,0 +1,313 @@
+#include "trajectory_recorder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+
+static uint64_t encodeZigzag(const int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+static int64_t decodeZigzag(const uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+static void appendVarint(std::vector<uint8_t> &bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+
+    bytes.push_back(uint8_t(value));
+}
+
+static bool readVarint(const uint8_t *&bytes, const uint8_t *bytesEnd, uint64_t &value) {
+    value = 0;
+
+    for (unsigned shift = 0; shift < 64 && bytes < bytesEnd; shift += 7) {
+        uint8_t byte = *bytes++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+
+    return false;
+}
+
+
+void TrajectoryDeltaBaselines::beginFrame(const MoleculeHandle *handles, const size_t moleculesCnt) {
+    MoleculeHandle maxHandle = 0;
+    for (size_t i = 0; i < moleculesCnt; i++)
+        maxHandle = std::max(maxHandle, handles[i]);
+
+    if (moleculesCnt > 0 && maxHandle >= handleNextFrames.size()) {
+        handleNextFrames.resize(size_t(maxHandle) + 1, 0);
+        for (std::vector<int64_t> &baselines : columnBaselines)
+            baselines.resize(size_t(maxHandle) + 1, 0);
+    }
+}
+
+void TrajectoryDeltaBaselines::finishFrame(const MoleculeHandle *handles, const size_t moleculesCnt) {
+    framesCnt++;
+    for (size_t i = 0; i < moleculesCnt; i++)
+        handleNextFrames[handles[i]] = framesCnt;
+}
+
+
+TrajectoryRecorder::TrajectoryRecorder
+(
+    const std::string &path, const size_t recordEveryTicks,
+    const size_t framesInFlightCnt
+) :
+    stream(path, std::ios::binary | std::ios::trunc),
+    recordEveryTicks(std::max<size_t>(recordEveryTicks, 1)), ticksCnt(0),
+    frames(framesInFlightCnt), queuedFrameSlots(framesInFlightCnt),
+    queuedFramesHead(0), queuedFramesCnt(0), isStopping(false),
+    recordedFramesCnt(0), droppedFramesCnt(0), isWriteFailed(false)
+{
+    assert(framesInFlightCnt > 0);
+    if (!stream) return;
+
+    for (size_t frameSlot = framesInFlightCnt; frameSlot-- > 0;)
+        freeFrameSlots.push_back(frameSlot);
+
+    TrajectoryFileHeader header = {};
+    header.magic = TRAJECTORY_FILE_MAGIC;
+    header.version = TRAJECTORY_FILE_VERSION;
+    header.headerSize = sizeof(TrajectoryFileHeader);
+    header.positionQuantum = TRAJECTORY_POSITION_QUANTUM;
+    header.speedQuantum = TRAJECTORY_SPEED_QUANTUM;
+    header.recordEveryTicks = this->recordEveryTicks;
+
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(TrajectoryFileHeader));
+    if (!stream) return;
+
+    writerThread = std::thread(&TrajectoryRecorder::writerLoop, this);
+}
+
+// queued frames are still written out before the writer stops
+TrajectoryRecorder::~TrajectoryRecorder() {
+    if (!writerThread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(framesMutex);
+        isStopping = true;
+    }
+
+    framesCondition.notify_one();
+    writerThread.join();
+}
+
+void TrajectoryRecorder::onTick(const MoleculeStore &moleculeStore, const double timePoint) {
+    uint64_t tickIndex = ticksCnt++;
+    if (!isOpen() || tickIndex % recordEveryTicks != 0) return;
+
+    size_t frameSlot = 0;
+    {
+        std::lock_guard<std::mutex> lock(framesMutex);
+        if (freeFrameSlots.empty()) {
+            droppedFramesCnt.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        frameSlot = freeFrameSlots.back();
+        freeFrameSlots.pop_back();
+    }
+
+    // the slot is out of both lists, the writer does not touch it until it is queued
+    TrajectoryFrame &frame = frames[frameSlot];
+    size_t moleculesCnt = moleculeStore.size();
+
+    frame.tickIndex = tickIndex;
+    frame.timePoint = timePoint;
+    frame.handles.assign(moleculeStore.getHandles(), moleculeStore.getHandles() + moleculesCnt);
+    frame.types.assign(moleculeStore.getMoleculeTypes(), moleculeStore.getMoleculeTypes() + moleculesCnt);
+    frame.masses.assign(moleculeStore.getMasses(), moleculeStore.getMasses() + moleculesCnt);
+    frame.xs.assign(moleculeStore.getXs(), moleculeStore.getXs() + moleculesCnt);
+    frame.ys.assign(moleculeStore.getYs(), moleculeStore.getYs() + moleculesCnt);
+    frame.speedXs.assign(moleculeStore.getSpeedXs(), moleculeStore.getSpeedXs() + moleculesCnt);
+    frame.speedYs.assign(moleculeStore.getSpeedYs(), moleculeStore.getSpeedYs() + moleculesCnt);
+
+    // dead molecules the core has not compacted away yet are dropped, keeping the order of the rest
+    const MoleculePhysicalStates *states = moleculeStore.getPhysicalStates();
+    if (std::find(states, states + moleculesCnt, DEATH) != states + moleculesCnt) {
+        size_t aliveCnt = 0;
+        for (size_t i = 0; i < moleculesCnt; i++) {
+            frame.handles[aliveCnt] = frame.handles[i];
+            frame.types[aliveCnt] = frame.types[i];
+            frame.masses[aliveCnt] = frame.masses[i];
+            frame.xs[aliveCnt] = frame.xs[i];
+            frame.ys[aliveCnt] = frame.ys[i];
+            frame.speedXs[aliveCnt] = frame.speedXs[i];
+            frame.speedYs[aliveCnt] = frame.speedYs[i];
+
+            aliveCnt += states[i] != DEATH;
+        }
+
+        frame.resize(aliveCnt);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(framesMutex);
+        queuedFrameSlots[(queuedFramesHead + queuedFramesCnt) % frames.size()] = frameSlot;
+        queuedFramesCnt++;
+    }
+
+    framesCondition.notify_one();
+}
+
+void TrajectoryRecorder::writerLoop() {
+    while (true) {
+        size_t frameSlot = 0;
+        {
+            std::unique_lock<std::mutex> lock(framesMutex);
+            framesCondition.wait(lock, [this]() { return queuedFramesCnt > 0 || isStopping; });
+            if (queuedFramesCnt == 0) break;
+
+            frameSlot = queuedFrameSlots[queuedFramesHead];
+            queuedFramesHead = (queuedFramesHead + 1) % frames.size();
+            queuedFramesCnt--;
+        }
+
+        writeFrame(frames[frameSlot]);
+
+        {
+            std::lock_guard<std::mutex> lock(framesMutex);
+            freeFrameSlots.push_back(frameSlot);
+        }
+    }
+
+    stream.flush();
+    if (!stream) isWriteFailed.store(true, std::memory_order_relaxed);
+}
+
+void TrajectoryRecorder::writeFrame(const TrajectoryFrame &frame) {
+    size_t moleculesCnt = frame.size();
+    for (std::vector<uint8_t> &bytes : columnBytes)
+        bytes.clear();
+
+    MoleculeHandle prevHandle = 0;
+    uint64_t handlesEnd = 0;
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        appendVarint(columnBytes[HANDLES_COLUMN], encodeZigzag(int64_t(frame.handles[i]) - int64_t(prevHandle)));
+        prevHandle = frame.handles[i];
+        handlesEnd = std::max(handlesEnd, uint64_t(frame.handles[i]) + 1);
+    }
+
+    const uint8_t *types = reinterpret_cast<const uint8_t *>(frame.types.data());
+    columnBytes[TYPES_COLUMN].assign(types, types + moleculesCnt);
+
+    deltaBaselines.beginFrame(frame.handles.data(), moleculesCnt);
+
+    auto encodeDeltaColumn = [&](const TrajectoryColumn column, auto getValue) {
+        for (size_t i = 0; i < moleculesCnt; i++) {
+            int64_t value = getValue(i);
+            appendVarint(columnBytes[column], encodeZigzag(value - deltaBaselines.getBaseline(column, frame.handles[i])));
+            deltaBaselines.setBaseline(column, frame.handles[i], value);
+        }
+    };
+
+    encodeDeltaColumn(MASSES_COLUMN,   [&](const size_t i) { return int64_t(frame.masses[i]); });
+    encodeDeltaColumn(XS_COLUMN,       [&](const size_t i) { return std::llround(frame.xs[i] / TRAJECTORY_POSITION_QUANTUM); });
+    encodeDeltaColumn(YS_COLUMN,       [&](const size_t i) { return std::llround(frame.ys[i] / TRAJECTORY_POSITION_QUANTUM); });
+    encodeDeltaColumn(SPEED_XS_COLUMN, [&](const size_t i) { return std::llround(frame.speedXs[i] / TRAJECTORY_SPEED_QUANTUM); });
+    encodeDeltaColumn(SPEED_YS_COLUMN, [&](const size_t i) { return std::llround(frame.speedYs[i] / TRAJECTORY_SPEED_QUANTUM); });
+
+    deltaBaselines.finishFrame(frame.handles.data(), moleculesCnt);
+
+    TrajectoryFrameHeader frameHeader = {};
+    frameHeader.tickIndex = frame.tickIndex;
+    frameHeader.timePoint = frame.timePoint;
+    frameHeader.moleculesCnt = moleculesCnt;
+    frameHeader.handlesEnd = handlesEnd;
+    for (size_t column = 0; column < TRAJECTORY_COLUMNS_CNT; column++)
+        frameHeader.columnSizes[column] = columnBytes[column].size();
+
+    stream.write(reinterpret_cast<const char *>(&frameHeader), sizeof(TrajectoryFrameHeader));
+    for (const std::vector<uint8_t> &bytes : columnBytes)
+        stream.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+
+    if (!stream) isWriteFailed.store(true, std::memory_order_relaxed);
+    else         recordedFramesCnt.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+TrajectoryReader::TrajectoryReader(const std::string &path): stream(path, std::ios::binary), header() {
+    if (!stream.read(reinterpret_cast<char *>(&header), sizeof(TrajectoryFileHeader))) return;
+
+    if (header.magic != TRAJECTORY_FILE_MAGIC || header.version != TRAJECTORY_FILE_VERSION ||
+        header.headerSize != sizeof(TrajectoryFileHeader))
+        stream.setstate(std::ios::failbit);
+}
+
+bool TrajectoryReader::readFrame(TrajectoryFrame &frame) {
+    TrajectoryFrameHeader frameHeader;
+    if (!stream.read(reinterpret_cast<char *>(&frameHeader), sizeof(TrajectoryFrameHeader))) return false;
+
+    // every molecule takes exactly one byte of the types column, which bounds moleculesCnt
+    size_t moleculesCnt = frameHeader.moleculesCnt;
+    if (frameHeader.columnSizes[TYPES_COLUMN] != moleculesCnt) return false;
+
+    // distinct handles need at least moleculesCnt values below handlesEnd
+    uint64_t handlesEnd = frameHeader.handlesEnd;
+    if (handlesEnd < moleculesCnt || handlesEnd > NONE_MOLECULE_HANDLE) return false;
+
+    for (size_t column = 0; column < TRAJECTORY_COLUMNS_CNT; column++) {
+        // a varint never takes more than 10 bytes, anything larger is a damaged chunk
+        if (frameHeader.columnSizes[column] > 10 * moleculesCnt) return false;
+
+        columnBytes[column].resize(frameHeader.columnSizes[column]);
+        if (!stream.read(reinterpret_cast<char *>(columnBytes[column].data()), columnBytes[column].size())) return false;
+    }
+
+    frame.tickIndex = frameHeader.tickIndex;
+    frame.timePoint = frameHeader.timePoint;
+    frame.resize(moleculesCnt);
+
+    const uint8_t *bytes = columnBytes[HANDLES_COLUMN].data();
+    const uint8_t *bytesEnd = bytes + columnBytes[HANDLES_COLUMN].size();
+    int64_t prevHandle = 0;
+    uint64_t decodedHandlesEnd = 0;
+    for (size_t i = 0; i < moleculesCnt; i++) {
+        uint64_t delta = 0;
+        if (!readVarint(bytes, bytesEnd, delta)) return false;
+
+        int64_t handle = prevHandle + decodeZigzag(delta);
+        if (handle < 0 || uint64_t(handle) >= handlesEnd) return false;
+
+        frame.handles[i] = MoleculeHandle(handle);
+        prevHandle = handle;
+        decodedHandlesEnd = std::max(decodedHandlesEnd, uint64_t(handle) + 1);
+    }
+
+    // the header bound must be the one the handles give, not merely above them
+    if (decodedHandlesEnd != handlesEnd) return false;
+
+    if (moleculesCnt > 0)
+        std::memcpy(frame.types.data(), columnBytes[TYPES_COLUMN].data(), moleculesCnt);
+
+    deltaBaselines.beginFrame(frame.handles.data(), moleculesCnt);
+
+    auto decodeDeltaColumn = [&](const TrajectoryColumn column, auto setValue) {
+        const uint8_t *bytes = columnBytes[column].data();
+        const uint8_t *bytesEnd = bytes + columnBytes[column].size();
+
+        for (size_t i = 0; i < moleculesCnt; i++) {
+            uint64_t delta = 0;
+            if (!readVarint(bytes, bytesEnd, delta)) return false;
+
+            int64_t value = deltaBaselines.getBaseline(column, frame.handles[i]) + decodeZigzag(delta);
+            deltaBaselines.setBaseline(column, frame.handles[i], value);
+            setValue(i, value);
+        }
+
+        return true;
+    };
+
+    bool isDecoded =
+        decodeDeltaColumn(MASSES_COLUMN,   [&](const size_t i, const int64_t value) { frame.masses[i] = int(value); }) &&
+        decodeDeltaColumn(XS_COLUMN,       [&](const size_t i, const int64_t value) { frame.xs[i] = value * header.positionQuantum; }) &&
+        decodeDeltaColumn(YS_COLUMN,       [&](const size_t i, const int64_t value) { frame.ys[i] = value * header.positionQuantum; }) &&
+        decodeDeltaColumn(SPEED_XS_COLUMN, [&](const size_t i, const int64_t value) { frame.speedXs[i] = value * header.speedQuantum; }) &&
+        decodeDeltaColumn(SPEED_YS_COLUMN, [&](const size_t i, const int64_t value) { frame.speedYs[i] = value * header.speedQuantum; });
+    if (!isDecoded) return false;
+
+    deltaBaselines.finishFrame(frame.handles.data(), moleculesCnt);
+    return true;
+}
@@ -0,0 +1,75 @@
+#include "worker_pool.h"
+
+#include <cassert>
+
+
+WorkerPool::WorkerPool(const size_t threadsCnt):
+    jobChunkFunc(nullptr), jobContext(nullptr), jobChunksCnt(0), jobNextChunk(0),
+    busyWorkersCnt(0), jobGeneration(0), stopping(false)
+{
+    assert(threadsCnt > 0);
+
+    workers.reserve(threadsCnt - 1);
+    for (size_t i = 0; i + 1 < threadsCnt; i++)
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobStartedCondition.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void WorkerPool::runJob(const size_t chunksCnt, ChunkFunc chunkFunc, void *context) {
+    if (chunksCnt == 0) return;
+
+    if (workers.empty() || chunksCnt == 1) {
+        for (size_t chunkIndex = 0; chunkIndex < chunksCnt; chunkIndex++)
+            chunkFunc(context, chunkIndex);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobChunkFunc = chunkFunc;
+        jobContext = context;
+        jobChunksCnt = chunksCnt;
+        jobNextChunk.store(0, std::memory_order_relaxed);
+        busyWorkersCnt = workers.size();
+        jobGeneration++;
+    }
+    jobStartedCondition.notify_all();
+
+    runJobChunks();
+
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobFinishedCondition.wait(lock, [this] { return busyWorkersCnt == 0; });
+}
+
+void WorkerPool::runJobChunks() {
+    for (size_t chunkIndex = jobNextChunk.fetch_add(1); chunkIndex < jobChunksCnt; chunkIndex = jobNextChunk.fetch_add(1))
+        jobChunkFunc(jobContext, chunkIndex);
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seenJobGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobStartedCondition.wait(lock, [&] { return stopping || jobGeneration != seenJobGeneration; });
+            if (stopping) return;
+            seenJobGeneration = jobGeneration;
+        }
+
+        runJobChunks();
+
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (--busyWorkersCnt == 0) jobFinishedCondition.notify_one();
+    }
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "box_integrator.h"
+
+static const uint64_t BOX_TEST_SEED = 12;
+static const size_t BOX_TEST_MOLECULES_CNT = 1003; // not a multiple of any vector width
+static const size_t BOX_TEST_STEPS_CNT = 50;
+
+static const double BOX_TEST_LEFT_WALL_X = 10;
+static const double BOX_TEST_RIGHT_WALL_X = 110;
+static const double BOX_TEST_HEIGHT = 80;
+static const double BOX_TEST_DELTA_SECS = 0.05;
+
+// impulse sums of different kernels add the same terms in different orders
+static const double BOX_TEST_IMPULSE_REL_TOLERANCE = 1e-12;
+
+static const SimdIsa VECTOR_SIMD_ISAS[] = {AVX2_SIMD_ISA, AVX512_SIMD_ISA};
+
+// Molecules mostly inside the box, a few outside it, fast enough that many bounce off
+// several walls within one step.
+struct BoxTestMolecules {
+    std::vector<double> xs, ys, speedXs, speedYs;
+    std::vector<int> masses;
+
+    BoxTestMolecules() {
+        std::mt19937 randomGenerator(BOX_TEST_SEED);
+        std::uniform_real_distribution<double> xDistribution(BOX_TEST_LEFT_WALL_X - 5, BOX_TEST_RIGHT_WALL_X + 5);
+        std::uniform_real_distribution<double> yDistribution(-5, BOX_TEST_HEIGHT + 5);
+        std::uniform_real_distribution<double> speedDistribution(-5000, 5000);
+        std::uniform_int_distribution<int> massDistribution(1, 10);
+
+        for (size_t i = 0; i < BOX_TEST_MOLECULES_CNT; i++) {
+            xs.push_back(xDistribution(randomGenerator));
+            ys.push_back(yDistribution(randomGenerator));
+            speedXs.push_back(speedDistribution(randomGenerator));
+            speedYs.push_back(speedDistribution(randomGenerator));
+            masses.push_back(massDistribution(randomGenerator));
+        }
+    }
+
+    // steps with the left wall running in as a piston, then running back out
+    void integrate(const SimdIsa isa, BoxWallImpulses *wallImpulses) {
+        for (size_t step = 0; step < BOX_TEST_STEPS_CNT; step++) {
+            double leftWallSpeed = (step < BOX_TEST_STEPS_CNT / 2) ? 100 : -100;
+            double leftWallX = BOX_TEST_LEFT_WALL_X + leftWallSpeed * BOX_TEST_DELTA_SECS * (step % 10);
+
+            if (wallImpulses)
+                integrateBoxMovement(xs.data(), ys.data(), speedXs.data(), speedYs.data(), masses.data(), xs.size(),
+                                     leftWallX, BOX_TEST_RIGHT_WALL_X, BOX_TEST_HEIGHT, leftWallSpeed,
+                                     BOX_TEST_DELTA_SECS, *wallImpulses, isa);
+            else
+                integrateBoxMovement(xs.data(), ys.data(), speedXs.data(), speedYs.data(), xs.size(),
+                                     leftWallX, BOX_TEST_RIGHT_WALL_X, BOX_TEST_HEIGHT, leftWallSpeed,
+                                     BOX_TEST_DELTA_SECS, isa);
+        }
+    }
+};
+
+static bool isBitIdentical(const std::vector<double> &fst, const std::vector<double> &snd) {
+    return fst.size() == snd.size() && std::memcmp(fst.data(), snd.data(), fst.size() * sizeof(double)) == 0;
+}
+
+static void expectImpulseNear(const double expected, const double actual) {
+    EXPECT_NEAR(expected, actual, std::abs(expected) * BOX_TEST_IMPULSE_REL_TOLERANCE);
+}
+
+static void expectMoleculesEqual(const BoxTestMolecules &expected, const BoxTestMolecules &actual) {
+    EXPECT_TRUE(isBitIdentical(expected.xs, actual.xs));
+    EXPECT_TRUE(isBitIdentical(expected.ys, actual.ys));
+    EXPECT_TRUE(isBitIdentical(expected.speedXs, actual.speedXs));
+    EXPECT_TRUE(isBitIdentical(expected.speedYs, actual.speedYs));
+}
+
+TEST(BoxIntegratorTest, VectorKernelsMatchScalarBitForBit) {
+    BoxTestMolecules scalarMolecules;
+    scalarMolecules.integrate(SCALAR_SIMD_ISA, /*wallImpulses=*/nullptr);
+
+    for (SimdIsa isa : VECTOR_SIMD_ISAS) {
+        if (!isSimdIsaSupported(isa)) continue;
+        SCOPED_TRACE(testing::Message() << "SIMD ISA " << isa);
+
+        BoxTestMolecules vectorMolecules;
+        vectorMolecules.integrate(isa, /*wallImpulses=*/nullptr);
+        expectMoleculesEqual(scalarMolecules, vectorMolecules);
+    }
+}
+
+// movement is the same with impulses accumulated, the impulse sums may only differ in rounding
+TEST(BoxIntegratorTest, ImpulseKernelsMatchScalar) {
+    BoxTestMolecules plainMolecules;
+    plainMolecules.integrate(SCALAR_SIMD_ISA, /*wallImpulses=*/nullptr);
+
+    BoxTestMolecules scalarMolecules;
+    BoxWallImpulses scalarImpulses;
+    scalarMolecules.integrate(SCALAR_SIMD_ISA, &scalarImpulses);
+    expectMoleculesEqual(plainMolecules, scalarMolecules);
+
+    for (SimdIsa isa : VECTOR_SIMD_ISAS) {
+        if (!isSimdIsaSupported(isa)) continue;
+        SCOPED_TRACE(testing::Message() << "SIMD ISA " << isa);
+
+        BoxTestMolecules vectorMolecules;
+        BoxWallImpulses vectorImpulses;
+        vectorMolecules.integrate(isa, &vectorImpulses);
+        expectMoleculesEqual(plainMolecules, vectorMolecules);
+
+        expectImpulseNear(scalarImpulses.leftWall, vectorImpulses.leftWall);
+        expectImpulseNear(scalarImpulses.rightWall, vectorImpulses.rightWall);
+        expectImpulseNear(scalarImpulses.lowWall, vectorImpulses.lowWall);
+        expectImpulseNear(scalarImpulses.highWall, vectorImpulses.highWall);
+    }
+}
+
+TEST(BoxIntegratorTest, MoleculesEndInsideBox) {
+    BoxTestMolecules molecules;
+    molecules.integrate(getBestSimdIsa(), /*wallImpulses=*/nullptr);
+
+    // the last step runs the wall outwards, (BOX_TEST_STEPS_CNT - 1) % 10 = 9 shifts of
+    // 100 * BOX_TEST_DELTA_SECS left of its start position: 10 - 45 = -35
+    double lastLeftWallX = BOX_TEST_LEFT_WALL_X - 100 * BOX_TEST_DELTA_SECS * ((BOX_TEST_STEPS_CNT - 1) % 10);
+    for (size_t i = 0; i < molecules.xs.size(); i++) {
+        EXPECT_GE(molecules.xs[i], lastLeftWallX);
+        EXPECT_LE(molecules.xs[i], BOX_TEST_RIGHT_WALL_X);
+        EXPECT_GE(molecules.ys[i], 0);
+        EXPECT_LE(molecules.ys[i], BOX_TEST_HEIGHT);
+    }
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include "reactor_test_utils.h"
+
+static const size_t DETECTION_TEST_STEPS_CNT = 100;
+
+static const CollisionDetectionMode BROAD_PHASE_DETECTION_MODES[] = {
+    UNIFORM_GRID_DETECTION,
+    SWEEP_AND_PRUNE_DETECTION,
+    AABB_TREE_DETECTION,
+};
+
+static std::unique_ptr<ReactorCore> runDetectionTestCore(const CollisionDetectionMode mode, const size_t threadsCnt=1) {
+    auto reactorCore = makeTestReactorCore();
+    reactorCore->setCollisionDetectionMode(mode);
+    reactorCore->setThreadsCnt(threadsCnt);
+    stepReactorCore(*reactorCore, DETECTION_TEST_STEPS_CNT);
+
+    return reactorCore;
+}
+
+// broad phases only prune candidate pairs: the pairs that react and their order must match walking
+// every pair, so whole runs stay bit-identical
+TEST(CollisionDetectionTest, BroadPhasesMatchBruteForce) {
+    auto bruteForceReactorCore = runDetectionTestCore(BRUTE_FORCE_DETECTION);
+
+    // the test is pointless unless molecules actually reacted
+    ASSERT_LT(bruteForceReactorCore->getObservables().getMoleculesCnt(CIRCLIT), TEST_CIRCLITS_CNT);
+
+    for (CollisionDetectionMode mode : BROAD_PHASE_DETECTION_MODES) {
+        SCOPED_TRACE(testing::Message() << "collision detection mode " << mode);
+        expectReactorCoresEqual(*bruteForceReactorCore, *runDetectionTestCore(mode));
+    }
+}
+
+TEST(CollisionDetectionTest, ParallelUniformGridMatchesBruteForce) {
+    auto bruteForceReactorCore = runDetectionTestCore(BRUTE_FORCE_DETECTION);
+    expectReactorCoresEqual(*bruteForceReactorCore, *runDetectionTestCore(UNIFORM_GRID_DETECTION, /*threadsCnt=*/4));
+}
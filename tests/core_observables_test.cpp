@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "reactor_test_utils.h"
+
+static const size_t OBSERVABLES_TEST_STEPS_CNT = 100;
+static const size_t OBSERVABLES_TEST_THREADS_CNT = 4;
+
+TEST(CoreObservablesTest, ThreadsCntDoesNotChangeObservables) {
+    auto serialReactorCore = makeTestReactorCore();
+    auto parallelReactorCore = makeTestReactorCore();
+    parallelReactorCore->setThreadsCnt(OBSERVABLES_TEST_THREADS_CNT);
+
+    stepReactorCore(*serialReactorCore, OBSERVABLES_TEST_STEPS_CNT);
+    stepReactorCore(*parallelReactorCore, OBSERVABLES_TEST_STEPS_CNT);
+
+    expectReactorCoresEqual(*serialReactorCore, *parallelReactorCore);
+
+    const CoreObservables &serialObservables = serialReactorCore->getObservables();
+    const CoreObservables &parallelObservables = parallelReactorCore->getObservables();
+
+    EXPECT_EQ(serialObservables.getKineticEnergy(), parallelObservables.getKineticEnergy());
+    EXPECT_EQ(serialObservables.getPressure(), parallelObservables.getPressure());
+    for (size_t wall = 0; wall < WALLS_CNT; wall++) {
+        WallType wallType = WallType(wall);
+        EXPECT_EQ(serialObservables.getWallImpulse(wallType), parallelObservables.getWallImpulse(wallType)) << "wall " << wall;
+        EXPECT_EQ(serialObservables.getWallPressure(wallType), parallelObservables.getWallPressure(wallType)) << "wall " << wall;
+    }
+}
+
+static const size_t RESCAN_TEST_STEPS_CNT = 300;
+// running sums and a rescan add the same terms in other orders
+static const double RESCAN_TEST_REL_TOLERANCE = 1e-9;
+
+// Every step, the aggregates kept up incrementally must match a rescan of the store. Reactions
+// here throw out Circlits fast enough that a plain running sum loses the rest of the box.
+TEST(CoreObservablesTest, RunningAggregatesMatchRescan) {
+    for (SteppingMode steppingMode : {FIXED_STEP_MODE, EVENT_DRIVEN_MODE, ADAPTIVE_STEP_MODE}) {
+        SCOPED_TRACE(testing::Message() << "stepping mode " << steppingMode);
+
+        auto reactorCore = makeTestReactorCore();
+        reactorCore->setSteppingMode(steppingMode);
+
+        for (size_t step = 0; step < RESCAN_TEST_STEPS_CNT; step++) {
+            reactorCore->step(REACTOR_CORE_UPDATE_SECS);
+            SCOPED_TRACE(testing::Message() << "step " << step);
+
+            const CoreObservables &observables = reactorCore->getObservables();
+            CoreObservables rescannedObservables;
+            rescannedObservables.recount(reactorCore->getMoleculeStore());
+
+            for (size_t moleculeType = 0; moleculeType < MOLECULE_TYPES_CNT; moleculeType++)
+                ASSERT_EQ(observables.getMoleculesCnt(MoleculeTypes(moleculeType)),
+                          rescannedObservables.getMoleculesCnt(MoleculeTypes(moleculeType)));
+            ASSERT_EQ(observables.getTotalMass(), rescannedObservables.getTotalMass());
+
+            double kineticEnergy = rescannedObservables.getKineticEnergy();
+            ASSERT_NEAR(observables.getKineticEnergy(), kineticEnergy, kineticEnergy * RESCAN_TEST_REL_TOLERANCE);
+
+            // momentum may cancel out, its scale is that of all the mass moving one way: sqrt(2 M E)
+            double momentumScale = std::sqrt(2 * rescannedObservables.getTotalMass() * kineticEnergy);
+            ASSERT_NEAR(observables.getMomentum().get_x(), rescannedObservables.getMomentum().get_x(), momentumScale * RESCAN_TEST_REL_TOLERANCE);
+            ASSERT_NEAR(observables.getMomentum().get_y(), rescannedObservables.getMomentum().get_y(), momentumScale * RESCAN_TEST_REL_TOLERANCE);
+        }
+    }
+}
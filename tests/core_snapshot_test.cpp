@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "core_snapshot.h"
+#include "reactor_test_utils.h"
+
+static const size_t SNAPSHOT_TEST_STEPS_BEFORE = 20;
+static const size_t SNAPSHOT_TEST_STEPS_AFTER = 50;
+
+static std::string saveSnapshotBytes(const ReactorCore &reactorCore) {
+    std::ostringstream stream;
+    EXPECT_TRUE(reactorCore.saveSnapshot(stream));
+    return stream.str();
+}
+
+// overwrites the element of store array arrayIndex at elementIndex in a saved snapshot
+template <typename Element>
+static void patchSnapshotElement
+(
+    std::string &snapshotBytes, const size_t arrayIndex, const size_t elementIndex, const Element value
+) {
+    CoreSnapshotHeader header;
+    std::memcpy(&header, snapshotBytes.data(), sizeof(CoreSnapshotHeader));
+
+    const CoreSnapshotArray &arrayInfo = header.arrays[arrayIndex];
+    ASSERT_EQ(arrayInfo.elementSize, sizeof(Element));
+    ASSERT_LT(elementIndex, arrayInfo.length);
+
+    std::memcpy(snapshotBytes.data() + arrayInfo.offset + elementIndex * sizeof(Element), &value, sizeof(Element));
+}
+
+TEST(CoreSnapshotTest, RestoredRunMatchesUninterruptedRun) {
+    auto reactorCore = makeTestReactorCore();
+    stepReactorCore(*reactorCore, SNAPSHOT_TEST_STEPS_BEFORE);
+    std::string snapshotBytes = saveSnapshotBytes(*reactorCore);
+
+    // another seed and other molecules, all of it must be replaced by the snapshot
+    auto restoredReactorCore = makeTestReactorCore(TEST_SEED + 1);
+    ASSERT_TRUE(restoredReactorCore->loadSnapshot(snapshotBytes.data(), snapshotBytes.size()));
+    expectReactorCoresEqual(*reactorCore, *restoredReactorCore);
+
+    // random streams continue where they were: spawning draws from them
+    for (ReactorCore *core : {reactorCore.get(), restoredReactorCore.get()}) {
+        core->addCirclit();
+        stepReactorCore(*core, SNAPSHOT_TEST_STEPS_AFTER);
+    }
+
+    expectReactorCoresEqual(*reactorCore, *restoredReactorCore);
+}
+
+class CoreSnapshotCorruptionTest : public testing::Test {
+protected:
+    std::unique_ptr<ReactorCore> savedReactorCore;
+    std::unique_ptr<ReactorCore> reactorCore;
+    std::string snapshotBytes;
+
+    void SetUp() override {
+        savedReactorCore = makeTestReactorCore();
+        stepReactorCore(*savedReactorCore, SNAPSHOT_TEST_STEPS_BEFORE);
+        snapshotBytes = saveSnapshotBytes(*savedReactorCore);
+
+        reactorCore = makeTestReactorCore(TEST_SEED + 1);
+    }
+
+    // the load fails and the core keeps what it had
+    void expectLoadRejected() {
+        auto untouchedReactorCore = makeTestReactorCore(TEST_SEED + 1);
+
+        EXPECT_FALSE(reactorCore->loadSnapshot(snapshotBytes.data(), snapshotBytes.size()));
+        expectReactorCoresEqual(*untouchedReactorCore, *reactorCore);
+    }
+};
+
+// array indices in forEachArray order
+static const size_t SNAPSHOT_TYPES_ARRAY = 6;
+static const size_t SNAPSHOT_STATES_ARRAY = 7;
+static const size_t SNAPSHOT_HANDLES_ARRAY = 8;
+static const size_t SNAPSHOT_HANDLE_INDICES_ARRAY = 9;
+static const size_t SNAPSHOT_FREE_HANDLES_ARRAY = 10;
+
+TEST_F(CoreSnapshotCorruptionTest, IntactSnapshotLoads) {
+    EXPECT_TRUE(reactorCore->loadSnapshot(snapshotBytes.data(), snapshotBytes.size()));
+}
+
+TEST_F(CoreSnapshotCorruptionTest, RejectsTruncatedFile) {
+    snapshotBytes.resize(snapshotBytes.size() / 2);
+    expectLoadRejected();
+}
+
+TEST_F(CoreSnapshotCorruptionTest, RejectsHandleOutOfRange) {
+    patchSnapshotElement<MoleculeHandle>(snapshotBytes, SNAPSHOT_HANDLES_ARRAY, 0, NONE_MOLECULE_HANDLE - 1);
+    expectLoadRejected();
+}
+
+TEST_F(CoreSnapshotCorruptionTest, RejectsDuplicateHandle) {
+    MoleculeHandle secondHandle = savedReactorCore->getMoleculeStore().getHandle(1);
+    patchSnapshotElement<MoleculeHandle>(snapshotBytes, SNAPSHOT_HANDLES_ARRAY, 0, secondHandle);
+    expectLoadRejected();
+}
+
+TEST_F(CoreSnapshotCorruptionTest, RejectsHandleIndexMismatch) {
+    MoleculeHandle firstHandle = savedReactorCore->getMoleculeStore().getHandle(0);
+    patchSnapshotElement<size_t>(snapshotBytes, SNAPSHOT_HANDLE_INDICES_ARRAY, firstHandle, 1);
+    expectLoadRejected();
+}
+
+TEST_F(CoreSnapshotCorruptionTest, RejectsUnknownMoleculeType) {
+    patchSnapshotElement<MoleculeTypes>(snapshotBytes, SNAPSHOT_TYPES_ARRAY, 0, MoleculeTypes(MOLECULE_TYPES_CNT));
+    expectLoadRejected();
+}
+
+TEST_F(CoreSnapshotCorruptionTest, RejectsUnknownPhysicalState) {
+    patchSnapshotElement<MoleculePhysicalStates>(
+        snapshotBytes, SNAPSHOT_STATES_ARRAY, 0, MoleculePhysicalStates(MOLECULE_PHYSICAL_STATES_CNT)
+    );
+    expectLoadRejected();
+}
+
+TEST_F(CoreSnapshotCorruptionTest, RejectsLiveHandleInFreeList) {
+    MoleculeHandle liveHandle = savedReactorCore->getMoleculeStore().getHandle(0);
+    patchSnapshotElement<MoleculeHandle>(snapshotBytes, SNAPSHOT_FREE_HANDLES_ARRAY, 0, liveHandle);
+    expectLoadRejected();
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#include "impact_kernel.h"
+
+static const uint64_t IMPACT_TEST_SEED = 11;
+static const size_t IMPACT_TEST_BATCHES_CNT = 500;
+static const double IMPACT_TEST_MAX_DELTA = 0.5;
+
+static const SimdIsa VECTOR_SIMD_ISAS[] = {AVX2_SIMD_ISA, AVX512_SIMD_ISA};
+
+// A batch of candidates around a molecule at the origin: hits, misses, overlaps, and candidates
+// sharing the molecule's speed, which have no time of impact at all.
+struct ImpactTestBatch {
+    double speedX, speedY, collideRadius;
+    double xs[IMPACT_BATCH_MAX_SIZE];
+    double ys[IMPACT_BATCH_MAX_SIZE];
+    double speedXs[IMPACT_BATCH_MAX_SIZE];
+    double speedYs[IMPACT_BATCH_MAX_SIZE];
+    double collideRadiuses[IMPACT_BATCH_MAX_SIZE];
+    size_t candidatesCnt;
+
+    explicit ImpactTestBatch(std::mt19937 &randomGenerator) {
+        std::uniform_real_distribution<double> cordDistribution(-20, 20);
+        std::uniform_real_distribution<double> speedDistribution(-50, 50);
+        std::uniform_real_distribution<double> radiusDistribution(0.5, 5);
+        std::uniform_int_distribution<size_t> cntDistribution(1, IMPACT_BATCH_MAX_SIZE);
+
+        speedX = speedDistribution(randomGenerator);
+        speedY = speedDistribution(randomGenerator);
+        collideRadius = radiusDistribution(randomGenerator);
+        candidatesCnt = cntDistribution(randomGenerator); // every tail length of the vector loops
+
+        for (size_t i = 0; i < candidatesCnt; i++) {
+            xs[i] = cordDistribution(randomGenerator);
+            ys[i] = cordDistribution(randomGenerator);
+            speedXs[i] = (i % 7 == 0) ? speedX : speedDistribution(randomGenerator);
+            speedYs[i] = (i % 7 == 0) ? speedY : speedDistribution(randomGenerator);
+            collideRadiuses[i] = radiusDistribution(randomGenerator);
+        }
+    }
+
+    uint64_t computeImpactDeltas(double *impactDeltas, const SimdIsa isa) const {
+        return ::computeImpactDeltas(
+            /*x=*/0, /*y=*/0, speedX, speedY, collideRadius,
+            xs, ys, speedXs, speedYs, collideRadiuses, candidatesCnt,
+            IMPACT_TEST_MAX_DELTA, impactDeltas, isa
+        );
+    }
+};
+
+TEST(ImpactKernelTest, VectorKernelsMatchScalarBitForBit) {
+    for (SimdIsa isa : VECTOR_SIMD_ISAS) {
+        if (!isSimdIsaSupported(isa)) continue;
+        SCOPED_TRACE(testing::Message() << "SIMD ISA " << isa);
+
+        std::mt19937 randomGenerator(IMPACT_TEST_SEED);
+        for (size_t batch = 0; batch < IMPACT_TEST_BATCHES_CNT; batch++) {
+            ImpactTestBatch testBatch(randomGenerator);
+
+            double scalarDeltas[IMPACT_BATCH_MAX_SIZE];
+            double vectorDeltas[IMPACT_BATCH_MAX_SIZE];
+            uint64_t scalarHitsMask = testBatch.computeImpactDeltas(scalarDeltas, SCALAR_SIMD_ISA);
+            uint64_t vectorHitsMask = testBatch.computeImpactDeltas(vectorDeltas, isa);
+
+            ASSERT_EQ(scalarHitsMask, vectorHitsMask) << "batch " << batch;
+            ASSERT_EQ(std::memcmp(scalarDeltas, vectorDeltas, testBatch.candidatesCnt * sizeof(double)), 0) << "batch " << batch;
+        }
+    }
+}
+
+// the scalar kernel against the textbook root, on a head-on hit and a miss
+TEST(ImpactKernelTest, ScalarKernelFindsSmallerRoot) {
+    static const double xs[] = {10, 10};
+    static const double ys[] = {0, 5};
+    static const double speedXs[] = {0, 0};
+    static const double speedYs[] = {0, 0};
+    static const double collideRadiuses[] = {1, 1};
+
+    double impactDeltas[2];
+    uint64_t hitsMask = computeImpactDeltas(
+        /*x=*/0, /*y=*/0, /*speedX=*/4, /*speedY=*/0, /*collideRadius=*/1,
+        xs, ys, speedXs, speedYs, collideRadiuses, /*candidatesCnt=*/2,
+        /*maxDelta=*/3, impactDeltas, SCALAR_SIMD_ISA
+    );
+
+    // the gap of 10 - 2 closes at 4 per second
+    EXPECT_EQ(impactDeltas[0], 2);
+    EXPECT_TRUE(std::isnan(impactDeltas[1]));
+    EXPECT_EQ(hitsMask, uint64_t(1));
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include "reactor_test_utils.h"
+
+static const size_t NARROW_PHASE_TEST_STEPS_CNT = 200;
+
+static const double PASSING_MOLECULE_X = 50;
+static const double RESTING_MOLECULE_X = 70;
+static const double PASSING_LANE_Y = 100;
+static const double PASSING_SPEED = 20;
+
+static const int QUADRIT_TEST_MASS = 10; // half side 5, collide circle radius about 7.07
+static const int CIRCLIT_TEST_MASS = 2;  // radius 2
+
+static const SteppingMode TEST_STEPPING_MODES[] = {FIXED_STEP_MODE, EVENT_DRIVEN_MODE, ADAPTIVE_STEP_MODE};
+
+// A molecule of passingType runs along the lane past a resting molecule of restingType whose
+// centre is laneOffset off the lane. Returns whether the two reacted.
+static bool isPassingMoleculeReacting
+(
+    const SteppingMode steppingMode,
+    const MoleculeTypes passingType, const int passingMass,
+    const MoleculeTypes restingType, const int restingMass,
+    const double laneOffset
+) {
+    ReactorCore reactorCore(TEST_CORE_SIDE, TEST_CORE_SIDE, TEST_SEED);
+    reactorCore.setSteppingMode(steppingMode);
+
+    reactorCore.addMolecule(
+        passingType, gm_vector<double, 2>(PASSING_MOLECULE_X, PASSING_LANE_Y), gm_vector<double, 2>(PASSING_SPEED, 0), passingMass
+    );
+    reactorCore.addMolecule(
+        restingType, gm_vector<double, 2>(RESTING_MOLECULE_X, PASSING_LANE_Y + laneOffset), gm_vector<double, 2>(0, 0), restingMass
+    );
+
+    stepReactorCore(reactorCore, NARROW_PHASE_TEST_STEPS_CNT);
+
+    // the reactions kill both reactants and, for these pairs, never leave exactly two molecules behind
+    return reactorCore.getObservables().getMoleculesCnt() != 2;
+}
+
+// Squares 10 apart along y never touch, their collide circles of radius 7.07 overlap all the way
+// past each other, so only the exact shapes tell these apart.
+TEST(NarrowPhaseTest, QuadritsReactOnlyWhenSquaresTouch) {
+    for (SteppingMode steppingMode : TEST_STEPPING_MODES) {
+        SCOPED_TRACE(testing::Message() << "stepping mode " << steppingMode);
+
+        EXPECT_FALSE(isPassingMoleculeReacting(steppingMode, QUADRIT, QUADRIT_TEST_MASS, QUADRIT, QUADRIT_TEST_MASS, /*laneOffset=*/10.5));
+        EXPECT_TRUE(isPassingMoleculeReacting(steppingMode, QUADRIT, QUADRIT_TEST_MASS, QUADRIT, QUADRIT_TEST_MASS, /*laneOffset=*/9.5));
+    }
+}
+
+// the circle touches the square at a lane offset of 5 + 2, the collide circles at 7.07 + 2
+TEST(NarrowPhaseTest, CirclitReactsOnlyWhenTouchingQuadritSide) {
+    for (SteppingMode steppingMode : TEST_STEPPING_MODES) {
+        SCOPED_TRACE(testing::Message() << "stepping mode " << steppingMode);
+
+        EXPECT_FALSE(isPassingMoleculeReacting(steppingMode, CIRCLIT, CIRCLIT_TEST_MASS, QUADRIT, QUADRIT_TEST_MASS, /*laneOffset=*/7.5));
+        EXPECT_TRUE(isPassingMoleculeReacting(steppingMode, CIRCLIT, CIRCLIT_TEST_MASS, QUADRIT, QUADRIT_TEST_MASS, /*laneOffset=*/6.5));
+    }
+}
+
+// circles are exact already, the bounding circle test alone decides
+TEST(NarrowPhaseTest, CirclitsReactWhenCirclesTouch) {
+    for (SteppingMode steppingMode : TEST_STEPPING_MODES) {
+        SCOPED_TRACE(testing::Message() << "stepping mode " << steppingMode);
+
+        EXPECT_FALSE(isPassingMoleculeReacting(steppingMode, CIRCLIT, CIRCLIT_TEST_MASS, CIRCLIT, CIRCLIT_TEST_MASS, /*laneOffset=*/4.5));
+        EXPECT_TRUE(isPassingMoleculeReacting(steppingMode, CIRCLIT, CIRCLIT_TEST_MASS, CIRCLIT, CIRCLIT_TEST_MASS, /*laneOffset=*/3.5));
+    }
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "philox.h"
+
+// Known-answer vectors of Philox4x32-10 from the Random123 distribution (kat_vectors):
+// counter words ctr[0..3] and key words key[0..1] in, four output words out
+struct PhiloxKnownAnswer {
+    uint32_t counter[PHILOX_BLOCK_WORDS_CNT];
+    uint32_t key[2];
+    PhiloxRandom::Block output;
+};
+
+static const PhiloxKnownAnswer PHILOX_KNOWN_ANSWERS[] = {
+    {{0x00000000, 0x00000000, 0x00000000, 0x00000000}, {0x00000000, 0x00000000},
+     {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+    {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff},
+     {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+    {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0},
+     {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}},
+};
+
+static uint64_t joinWords(const uint32_t loWord, const uint32_t hiWord) { return (uint64_t(hiWord) << 32) | loWord; }
+
+// the block index fills counter words 0 and 1, the stream index words 2 and 3, the seed is the key
+TEST(PhiloxTest, GenerateBlockMatchesKnownAnswers) {
+    for (const PhiloxKnownAnswer &knownAnswer : PHILOX_KNOWN_ANSWERS) {
+        PhiloxRandom randomGenerator(joinWords(knownAnswer.key[0], knownAnswer.key[1]));
+
+        PhiloxRandom::Block block = randomGenerator.generateBlock(
+            /*streamIndex=*/joinWords(knownAnswer.counter[2], knownAnswer.counter[3]),
+            /*blockIndex=*/joinWords(knownAnswer.counter[0], knownAnswer.counter[1])
+        );
+        EXPECT_EQ(block, knownAnswer.output);
+    }
+}
+
+// any uniform can be drawn on its own: a batch equals the same uniforms drawn one by one
+TEST(PhiloxTest, BatchedUniformsMatchSingleDraws) {
+    static const uint64_t STREAM_INDEX = 7;
+    static const uint64_t FIRST_UNIFORM_INDEX = 3; // odd, so the batch starts mid-block
+    static const size_t UNIFORMS_CNT = 9;
+
+    PhiloxRandom randomGenerator(/*seed=*/42);
+
+    double batchUniforms[UNIFORMS_CNT];
+    randomGenerator.generateUniforms(STREAM_INDEX, FIRST_UNIFORM_INDEX, batchUniforms, UNIFORMS_CNT);
+
+    for (size_t i = 0; i < UNIFORMS_CNT; i++) {
+        double uniform = 0;
+        randomGenerator.generateUniforms(STREAM_INDEX, FIRST_UNIFORM_INDEX + i, &uniform, 1);
+
+        EXPECT_EQ(batchUniforms[i], uniform) << "uniform " << i;
+        EXPECT_GE(uniform, 0);
+        EXPECT_LT(uniform, 1);
+    }
+}
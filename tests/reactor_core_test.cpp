@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "reactor_test_utils.h"
+
+static const size_t REPRODUCIBILITY_TEST_STEPS_CNT = 100;
+
+static void runSeededReactorCore(ReactorCore &reactorCore) {
+    stepReactorCore(reactorCore, REPRODUCIBILITY_TEST_STEPS_CNT / 2);
+
+    // spawns draw from the random streams mid-run too
+    reactorCore.addCirclit();
+    reactorCore.addQuadrit();
+    stepReactorCore(reactorCore, REPRODUCIBILITY_TEST_STEPS_CNT / 2);
+}
+
+TEST(ReactorCoreTest, SameSeedRunsAreBitIdentical) {
+    auto fstReactorCore = makeTestReactorCore();
+    auto sndReactorCore = makeTestReactorCore();
+
+    runSeededReactorCore(*fstReactorCore);
+    runSeededReactorCore(*sndReactorCore);
+
+    expectReactorCoresEqual(*fstReactorCore, *sndReactorCore);
+}
+
+TEST(ReactorCoreTest, SetSeedRestartsRandomStreams) {
+    auto fstReactorCore = makeTestReactorCore();
+
+    // draws made before setSeed must not leak into the run
+    auto sndReactorCore = std::make_unique<ReactorCore>(TEST_CORE_SIDE, TEST_CORE_SIDE, TEST_SEED + 1);
+    sndReactorCore->randRange(0, 1);
+    sndReactorCore->setSeed(TEST_SEED);
+    sndReactorCore->addMolecules(CIRCLIT, TEST_CIRCLITS_CNT, UNIFORM_SPAWN);
+    sndReactorCore->addMolecules(QUADRIT, TEST_QUADRITS_CNT, UNIFORM_SPAWN);
+    sndReactorCore->setPistonTarget(TEST_PISTON_TARGET);
+
+    runSeededReactorCore(*fstReactorCore);
+    runSeededReactorCore(*sndReactorCore);
+
+    expectReactorCoresEqual(*fstReactorCore, *sndReactorCore);
+}
+
+TEST(ReactorCoreTest, OtherSeedGivesOtherRun) {
+    auto fstReactorCore = makeTestReactorCore();
+    auto sndReactorCore = makeTestReactorCore(TEST_SEED + 1);
+
+    EXPECT_NE(getMoleculeStoreBytes(fstReactorCore->getMoleculeStore()),
+              getMoleculeStoreBytes(sndReactorCore->getMoleculeStore()));
+}
+
+// Compaction is stable and dead molecules are frozen out of every phase, so deferring it changes
+// nothing about the survivors; only handles differ, as they are freed and reused later.
+TEST(ReactorCoreTest, DeferredCompactionKeepsSurvivors) {
+    for (SteppingMode steppingMode : {FIXED_STEP_MODE, ADAPTIVE_STEP_MODE}) {
+        SCOPED_TRACE(testing::Message() << "stepping mode " << steppingMode);
+
+        auto eagerReactorCore = makeTestReactorCore();
+        auto deferredReactorCore = makeTestReactorCore();
+        eagerReactorCore->setSteppingMode(steppingMode);
+        deferredReactorCore->setSteppingMode(steppingMode);
+        deferredReactorCore->setDeadCompactionShare(1);
+
+        stepReactorCore(*eagerReactorCore, REPRODUCIBILITY_TEST_STEPS_CNT);
+        stepReactorCore(*deferredReactorCore, REPRODUCIBILITY_TEST_STEPS_CNT);
+
+        const MoleculeStore &deferredStore = deferredReactorCore->getMoleculeStore();
+        size_t deadCnt = 0;
+        for (size_t i = 0; i < deferredStore.size(); i++) {
+            if (deferredStore.getPhysicalState(i) != DEATH) continue;
+
+            deadCnt++;
+            EXPECT_EQ(deferredStore.getMass(i), 0);
+            EXPECT_EQ(deferredStore.getCollideCircleRadius(i), 0);
+        }
+        ASSERT_GT(deadCnt, 0);
+
+        // the running sums are only re-anchored by compaction, a rescan of the survivors must agree
+        CoreObservables eagerRescan, deferredRescan;
+        eagerRescan.recount(eagerReactorCore->getMoleculeStore());
+        deferredRescan.recount(deferredReactorCore->getMoleculeStore());
+        EXPECT_EQ(eagerRescan.getKineticEnergy(), deferredRescan.getKineticEnergy());
+        EXPECT_EQ(eagerReactorCore->getObservables().getPressure(), deferredReactorCore->getObservables().getPressure());
+
+        const MoleculeStore &eagerStore = eagerReactorCore->getMoleculeStore();
+        size_t eagerIndex = 0;
+        for (size_t i = 0; i < deferredStore.size(); i++) {
+            if (deferredStore.getPhysicalState(i) == DEATH) continue;
+
+            ASSERT_LT(eagerIndex, eagerStore.size());
+            EXPECT_EQ(eagerStore.getMoleculeType(eagerIndex), deferredStore.getMoleculeType(i));
+            EXPECT_EQ(eagerStore.getMass(eagerIndex), deferredStore.getMass(i));
+            EXPECT_EQ(eagerStore.getPosition(eagerIndex).get_x(), deferredStore.getPosition(i).get_x());
+            EXPECT_EQ(eagerStore.getPosition(eagerIndex).get_y(), deferredStore.getPosition(i).get_y());
+            EXPECT_EQ(eagerStore.getSpeedVector(eagerIndex).get_x(), deferredStore.getSpeedVector(i).get_x());
+            EXPECT_EQ(eagerStore.getSpeedVector(eagerIndex).get_y(), deferredStore.getSpeedVector(i).get_y());
+            eagerIndex++;
+        }
+        EXPECT_EQ(eagerIndex, eagerStore.size());
+    }
+}
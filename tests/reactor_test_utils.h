@@ -0,0 +1,64 @@
+#ifndef REACTOR_TEST_UTILS_H
+#define REACTOR_TEST_UTILS_H
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "reactorcore.h"
+
+static const uint64_t TEST_SEED = 20251017;
+static const double TEST_CORE_SIDE = 200;
+static const size_t TEST_CIRCLITS_CNT = 600;
+static const size_t TEST_QUADRITS_CNT = 100;
+static const double TEST_PISTON_TARGET = 50;
+
+// a small crowded core with both molecule types, a moving piston and reactions in the first steps
+inline std::unique_ptr<ReactorCore> makeTestReactorCore(const uint64_t seed=TEST_SEED) {
+    auto reactorCore = std::make_unique<ReactorCore>(TEST_CORE_SIDE, TEST_CORE_SIDE, seed);
+    reactorCore->addMolecules(CIRCLIT, TEST_CIRCLITS_CNT, UNIFORM_SPAWN);
+    reactorCore->addMolecules(QUADRIT, TEST_QUADRITS_CNT, UNIFORM_SPAWN);
+    reactorCore->setPistonTarget(TEST_PISTON_TARGET);
+
+    return reactorCore;
+}
+
+inline void stepReactorCore(ReactorCore &reactorCore, const size_t stepsCnt) {
+    for (size_t step = 0; step < stepsCnt; step++)
+        reactorCore.step(REACTOR_CORE_UPDATE_SECS);
+}
+
+// every store array as raw bytes, in forEachArray order
+inline std::vector<std::string> getMoleculeStoreBytes(const MoleculeStore &moleculeStore) {
+    std::vector<std::string> arraysBytes;
+    moleculeStore.forEachArray([&](const auto &array) {
+        typedef typename std::decay_t<decltype(array)>::value_type Element;
+        arraysBytes.emplace_back(reinterpret_cast<const char *>(array.data()), array.size() * sizeof(Element));
+    });
+
+    return arraysBytes;
+}
+
+// bit-identical, not merely close: the runs compared here must not differ in rounding either
+inline void expectMoleculeStoresEqual(const MoleculeStore &expected, const MoleculeStore &actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+
+    std::vector<std::string> expectedBytes = getMoleculeStoreBytes(expected);
+    std::vector<std::string> actualBytes = getMoleculeStoreBytes(actual);
+    for (size_t arrayIndex = 0; arrayIndex < expectedBytes.size(); arrayIndex++)
+        EXPECT_TRUE(expectedBytes[arrayIndex] == actualBytes[arrayIndex]) << "store array " << arrayIndex << " differs";
+}
+
+inline void expectReactorCoresEqual(const ReactorCore &expected, const ReactorCore &actual) {
+    expectMoleculeStoresEqual(expected.getMoleculeStore(), actual.getMoleculeStore());
+
+    EXPECT_EQ(expected.getCurrentTime(), actual.getCurrentTime());
+    EXPECT_EQ(expected.getPistonPosition(), actual.getPistonPosition());
+    EXPECT_EQ(expected.getPistonSpeed(), actual.getPistonSpeed());
+}
+
+#endif // REACTOR_TEST_UTILS_H
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "reactor_test_utils.h"
+#include "trajectory_recorder.h"
+
+static const size_t TRAJECTORY_TEST_STEPS_CNT = 10;
+static const size_t SMALL_TRAJECTORY_CIRCLITS_CNT = 10; // every handle fits a one-byte varint
+
+static std::string getTrajectoryTestPath(const std::string &name) { return testing::TempDir() + name; }
+
+// Records every step, the recorder is gone and the file flushed on return. A frame in flight per
+// step keeps a slow writer from dropping any.
+static void recordTrajectory(ReactorCore &reactorCore, const std::string &path) {
+    TrajectoryRecorder recorder(path, /*recordEveryTicks=*/1, /*framesInFlightCnt=*/TRAJECTORY_TEST_STEPS_CNT);
+    EXPECT_TRUE(recorder.isOpen());
+
+    reactorCore.setTrajectoryRecorder(&recorder);
+    stepReactorCore(reactorCore, TRAJECTORY_TEST_STEPS_CNT);
+    reactorCore.setTrajectoryRecorder(nullptr);
+    EXPECT_EQ(recorder.getDroppedFramesCnt(), 0u);
+}
+
+static void recordSmallTrajectory(const std::string &path) {
+    ReactorCore reactorCore(TEST_CORE_SIDE, TEST_CORE_SIDE, TEST_SEED);
+    reactorCore.addMolecules(CIRCLIT, SMALL_TRAJECTORY_CIRCLITS_CNT, POISSON_DISK_SPAWN);
+    recordTrajectory(reactorCore, path);
+}
+
+static std::string readFileBytes(const std::string &path) {
+    std::ifstream stream(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+static void writeFileBytes(const std::string &path, const std::string &bytes) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(bytes.data(), bytes.size());
+}
+
+TEST(TrajectoryRecorderTest, LastFrameMatchesStore) {
+    std::string path = getTrajectoryTestPath("round_trip.traj");
+    auto reactorCore = makeTestReactorCore();
+    recordTrajectory(*reactorCore, path);
+
+    TrajectoryReader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+
+    TrajectoryFrame frame;
+    size_t framesCnt = 0;
+    while (reader.readFrame(frame))
+        framesCnt++;
+    ASSERT_EQ(framesCnt, TRAJECTORY_TEST_STEPS_CNT);
+
+    const MoleculeStore &moleculeStore = reactorCore->getMoleculeStore();
+    ASSERT_EQ(frame.size(), moleculeStore.size());
+    for (size_t i = 0; i < frame.size(); i++) {
+        EXPECT_EQ(frame.handles[i], moleculeStore.getHandle(i));
+        EXPECT_EQ(frame.types[i], moleculeStore.getMoleculeType(i));
+        EXPECT_EQ(frame.masses[i], moleculeStore.getMass(i));
+        EXPECT_LE(std::abs(frame.xs[i] - moleculeStore.getPosition(i).get_x()), TRAJECTORY_POSITION_QUANTUM / 2);
+        EXPECT_LE(std::abs(frame.ys[i] - moleculeStore.getPosition(i).get_y()), TRAJECTORY_POSITION_QUANTUM / 2);
+    }
+}
+
+// the first handle of the first chunk is decoded from 0, patched to the largest one-byte value
+TEST(TrajectoryRecorderTest, RejectsHandleBeyondFrameBound) {
+    std::string path = getTrajectoryTestPath("damaged_handle.traj");
+    recordSmallTrajectory(path);
+
+    std::string bytes = readFileBytes(path);
+    TrajectoryFrameHeader frameHeader;
+    ASSERT_GT(bytes.size(), sizeof(TrajectoryFileHeader) + sizeof(TrajectoryFrameHeader));
+    std::memcpy(&frameHeader, bytes.data() + sizeof(TrajectoryFileHeader), sizeof(TrajectoryFrameHeader));
+    ASSERT_LT(frameHeader.handlesEnd, 64u);
+
+    bytes[sizeof(TrajectoryFileHeader) + sizeof(TrajectoryFrameHeader)] = char(0x7E); // zigzag of 63
+    writeFileBytes(path, bytes);
+
+    TrajectoryReader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+
+    TrajectoryFrame frame;
+    EXPECT_FALSE(reader.readFrame(frame));
+}
+
+TEST(TrajectoryRecorderTest, RejectsFrameBoundBelowMoleculesCnt) {
+    std::string path = getTrajectoryTestPath("damaged_bound.traj");
+    recordSmallTrajectory(path);
+
+    std::string bytes = readFileBytes(path);
+    TrajectoryFrameHeader frameHeader;
+    std::memcpy(&frameHeader, bytes.data() + sizeof(TrajectoryFileHeader), sizeof(TrajectoryFrameHeader));
+
+    frameHeader.handlesEnd = frameHeader.moleculesCnt - 1;
+    std::memcpy(bytes.data() + sizeof(TrajectoryFileHeader), &frameHeader, sizeof(TrajectoryFrameHeader));
+    writeFileBytes(path, bytes);
+
+    TrajectoryReader reader(path);
+    TrajectoryFrame frame;
+    EXPECT_FALSE(reader.readFrame(frame));
+}